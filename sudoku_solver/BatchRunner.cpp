@@ -0,0 +1,231 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "BatchRunner.h"
+#include "SBoardTables.h"
+#include "PuzzleParser.h"
+#include "CheckpointFile.h"
+#include <cstdlib>
+
+namespace {
+
+	constexpr uint64_t CHECKPOINT_CLOCK_LINES = 64;	// lines between looks at the clock
+
+	std::string_view Trim(std::string_view s)
+	{
+		auto first = s.find_first_not_of(" \t\r\n");
+		if (first == std::string_view::npos)
+			return {};
+		auto last = s.find_last_not_of(" \t\r\n");
+		return s.substr(first, last - first + 1);
+	}
+
+	/*
+	* The column names on the first line of the test data files, such as
+	* "Puzzle,Solution," or "quizzes,solutions". Any puzzle has a digit or a '.'.
+	*/
+	bool IsHeader(std::string_view line)
+	{
+		return line.find_first_of("0123456789.") == std::string_view::npos;
+	}
+}
+
+/*
+* Same rules as SolverService::ParseRequest().
+*/
+std::string_view BatchRunner::GetPuzzleField(std::string_view line)
+{
+	auto comma = line.find(',');
+	if (comma == std::string_view::npos)
+		return line;
+
+	auto first = Trim(line.substr(0, comma));
+	if (first.size() == SBoardTables::CellCount)
+		return first;
+
+	auto next = line.find(',', comma + 1);
+	return Trim(line.substr(comma + 1, (next == std::string_view::npos) ? std::string_view::npos : next - comma - 1));
+}
+
+bool BatchRunner::SolveLine(std::string_view line, SolutionWriter& writer)
+{
+	line = Trim(line);
+	if (line.empty())
+		return true;
+
+	m_stats.lines++;
+	auto puzzle = GetPuzzleField(line);
+
+	SParsedPuzzle parsed;
+	if (PuzzleParser::Parse(puzzle, parsed) != SParseResult::Ok) {
+		m_stats.invalid++;
+		return writer.Write(puzzle, nullptr);
+	}
+
+	int steps = 0;
+	parsed.ToBoard(m_board);
+	auto result = m_solver.SolveWithStatus(m_board, &m_solvedBoard, steps);
+	if (result != SSolveStatus::Solved) {
+		if (result == SSolveStatus::Unsolved) {
+			m_stats.unsolved++;
+		}
+		else {
+			m_stats.aborted++;
+		}
+		return writer.Write(puzzle, nullptr);
+	}
+
+	char solution[SBoardTables::CellCount];
+	m_solver.GetBoardAsStringLayout(m_solvedBoard, solution);
+	m_stats.solved++;
+	return writer.Write(puzzle, solution);
+}
+
+bool BatchRunner::Run(const std::string& input_path, SolutionWriter& writer)
+{
+	LineReader reader;
+	if (!reader.Open(input_path))
+		return false;
+
+	// A range starts after the line that runs into it, unless that line ends
+	// just before it.
+	if (m_rangeBegin > 0) {
+		std::string_view line;
+		if (!reader.Seek(m_rangeBegin - 1, 0))
+			return false;
+		reader.ReadLine(line);
+	}
+	reader.SetLimit(m_rangeEnd);
+	return Run(reader, writer);
+}
+
+bool BatchRunner::Run(FILE* input, SolutionWriter& writer)
+{
+	LineReader reader;
+	reader.Attach(input);
+	return Run(reader, writer);
+}
+
+bool BatchRunner::Resume(const std::string& input_path, const SBatchCheckpoint& checkpoint, SolutionWriter& writer)
+{
+	LineReader reader;
+	if (!reader.Open(input_path) || !reader.Seek(checkpoint.input_offset, checkpoint.line_number))
+		return false;
+
+	reader.SetLimit(m_rangeEnd);
+	m_stats = checkpoint.stats;
+	return Run(reader, writer);
+}
+
+void BatchRunner::SetInputRange(uint64_t begin, uint64_t end)
+{
+	m_rangeBegin = begin;
+	m_rangeEnd = end;
+}
+
+void BatchRunner::GetShardRange(uint64_t file_size, int index, int count, uint64_t& begin, uint64_t& end)
+{
+	// Split by whole shares of the size, then the remainder, to avoid overflow.
+	uint64_t share = file_size / count;
+	uint64_t remainder = file_size % count;
+	begin = share * index + (remainder * index) / count;
+	end = share * (index + 1) + (remainder * (index + 1)) / count;
+}
+
+bool BatchRunner::ParseShard(std::string_view text, int& index, int& count)
+{
+	auto slash = text.find('/');
+	if ((slash == std::string_view::npos) || (slash == 0) || (slash + 1 == text.size()))
+		return false;
+
+	std::string index_text(text.substr(0, slash));
+	std::string count_text(text.substr(slash + 1));
+	char* end = nullptr;
+	long i = std::strtol(index_text.c_str(), &end, 10);
+	if (*end != '\0')
+		return false;
+	long n = std::strtol(count_text.c_str(), &end, 10);
+	if ((*end != '\0') || (i < 0) || (n < 1) || (i >= n))
+		return false;
+
+	index = static_cast<int>(i);
+	count = static_cast<int>(n);
+	return true;
+}
+
+/*
+* Each is saved with its mode, so it cannot be resumed as an enumeration.
+*/
+bool BatchRunner::SaveCheckpoint(const std::string& path, const SBatchCheckpoint& checkpoint)
+{
+	CheckpointFile file;
+	file.SetValue("mode", "batch");
+	file.SetNumber("input_offset", checkpoint.input_offset);
+	file.SetNumber("line_number", checkpoint.line_number);
+	file.SetNumber("output_size", checkpoint.output_size);
+	file.SetNumber("lines", checkpoint.stats.lines);
+	file.SetNumber("solved", checkpoint.stats.solved);
+	file.SetNumber("unsolved", checkpoint.stats.unsolved);
+	file.SetNumber("invalid", checkpoint.stats.invalid);
+	file.SetNumber("aborted", checkpoint.stats.aborted);
+	return file.Save(path);
+}
+
+bool BatchRunner::LoadCheckpoint(const std::string& path, SBatchCheckpoint& checkpoint)
+{
+	CheckpointFile file;
+	if (!file.Load(path) || (file.GetValue("mode") != "batch"))
+		return false;
+
+	checkpoint.input_offset = file.GetNumber("input_offset");
+	checkpoint.line_number = file.GetNumber("line_number");
+	checkpoint.output_size = file.GetNumber("output_size");
+	checkpoint.stats.lines = file.GetNumber("lines");
+	checkpoint.stats.solved = file.GetNumber("solved");
+	checkpoint.stats.unsolved = file.GetNumber("unsolved");
+	checkpoint.stats.invalid = file.GetNumber("invalid");
+	checkpoint.stats.aborted = file.GetNumber("aborted");
+	return true;
+}
+
+void BatchRunner::SetCheckpoint(const CheckpointCallback& callback, double interval_seconds)
+{
+	m_onCheckpoint = callback;
+	m_checkpointInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval_seconds));
+}
+
+bool BatchRunner::Run(LineReader& reader, SolutionWriter& writer)
+{
+	bool is_ok = true;
+	auto next_checkpoint = std::chrono::steady_clock::now() + m_checkpointInterval;
+
+	std::string_view line;
+	while (reader.ReadLine(line)) {
+		if ((reader.GetLineNumber() == 1) && IsHeader(line))
+			continue;
+
+		is_ok &= SolveLine(line, writer);
+
+		// The checkpoint is only taken once the output is written up to it.
+		if (m_onCheckpoint && ((reader.GetLineNumber() % CHECKPOINT_CLOCK_LINES) == 0) &&
+			(std::chrono::steady_clock::now() >= next_checkpoint)) {
+
+			is_ok &= writer.Flush();
+			SBatchCheckpoint checkpoint{ reader.GetOffset(), reader.GetLineNumber(), writer.GetBytesWritten(), m_stats };
+			if (!is_ok || !m_onCheckpoint(checkpoint))
+				return false;
+
+			next_checkpoint = std::chrono::steady_clock::now() + m_checkpointInterval;
+		}
+	}
+
+	is_ok &= !reader.HasFailed();
+	if (m_onCheckpoint && is_ok) {
+		is_ok &= writer.Flush();
+		SBatchCheckpoint checkpoint{ reader.GetOffset(), reader.GetLineNumber(), writer.GetBytesWritten(), m_stats };
+		is_ok = is_ok && m_onCheckpoint(checkpoint);
+	}
+	return is_ok;
+}
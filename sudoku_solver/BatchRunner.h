@@ -0,0 +1,187 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SudokuSolver.h"
+#include "SolutionWriter.h"
+#include "LineReader.h"
+#include <string>
+#include <string_view>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+/**
+ * @brief Counts kept by `BatchRunner`
+ */
+struct SBatchStats
+{
+    uint64_t lines = 0;         // non blank input lines, other than a header
+    uint64_t solved = 0;
+    uint64_t unsolved = 0;
+    uint64_t invalid = 0;       // not a puzzle, or duplicate givens
+    uint64_t aborted = 0;       // ran out of budget
+};
+
+/**
+ * @brief The progress of a batch run, from which it can be resumed
+ */
+struct SBatchCheckpoint
+{
+    uint64_t input_offset = 0;      // start of the first line not yet solved
+    uint64_t line_number = 0;       // lines read before it
+    uint64_t output_size = 0;       // bytes of output written for the lines before it
+    SBatchStats stats;
+};
+
+/**
+ * @class BatchRunner
+ * @brief Solves every puzzle of an input file, writing one output line per puzzle
+ *
+ * Input lines are the same as for `SolverService`: a bare puzzle, `id,puzzle`,
+ * or the `puzzle,solution` rows of the test data files. A first line with no
+ * cells in it, such as the header of those files, is skipped. The input is
+ * read in large blocks by a `LineReader`, and each line is parsed in place.
+ *
+ * Output lines are written through a `SolutionWriter`, in input order. Puzzles
+ * that are invalid, cannot be solved or run out of budget still get a line,
+ * with an empty solution.
+ *
+ * If a checkpoint callback is set, the output is flushed and the callback
+ * given the progress so far, at most once per interval, and once more at the
+ * end of the input. Time is only checked every few lines.
+ *
+ * A run from a file can be limited to a byte range of it, so that a large
+ * file can be split between processes (see `GetShardRange()`).
+ */
+class BatchRunner
+{
+public:
+
+    /**
+     * @brief Solves all the puzzles in the file
+     * @return False if the file could not be read, or the output failed
+     */
+    bool Run(const std::string& input_path, SolutionWriter& writer);
+
+    /**
+     * @brief As above, reading from an open stream (e.g. stdin)
+     */
+    bool Run(FILE* input, SolutionWriter& writer);
+
+    /**
+     * @brief As above, reading the remaining lines of the reader
+     */
+    bool Run(LineReader& reader, SolutionWriter& writer);
+
+    /**
+     * @brief Continues a run from a checkpoint, solving the rest of the file
+     *
+     * The writer must already hold the output up to the checkpoint (see
+     * `SolutionWriter::ResumeFile()`). The stats carry on from the checkpoint.
+     */
+    bool Resume(const std::string& input_path, const SBatchCheckpoint& checkpoint, SolutionWriter& writer);
+
+    /**
+     * @brief Only solves the lines that start within [begin, end) of the input file
+     *
+     * Each line belongs to the range that its first byte is in, so ranges that
+     * split a file between them cover every line exactly once. This applies to
+     * `Run()` and `Resume()` from a file path.
+     */
+    void SetInputRange(uint64_t begin, uint64_t end);
+
+    /**
+     * @brief Returns the byte range of a file of the given size for shard index of count
+     */
+    static void GetShardRange(uint64_t file_size, int index, int count, uint64_t& begin, uint64_t& end);
+
+    /**
+     * @brief Parses a shard given as "index/count", with 0 <= index < count
+     */
+    static bool ParseShard(std::string_view text, int& index, int& count);
+
+    /**
+     * @brief Saves a checkpoint to a `CheckpointFile`
+     */
+    static bool SaveCheckpoint(const std::string& path, const SBatchCheckpoint& checkpoint);
+
+    /**
+     * @brief Loads a checkpoint saved by `SaveCheckpoint()`
+     * @return False if the file cannot be read, or is not a batch checkpoint
+     */
+    static bool LoadCheckpoint(const std::string& path, SBatchCheckpoint& checkpoint);
+
+    /**
+     * @brief Receives each checkpoint. Return false to stop the run.
+     */
+    using CheckpointCallback = std::function<bool(const SBatchCheckpoint& checkpoint)>;
+
+    /**
+     * @brief Sets the callback for checkpoints, or an empty one for none
+     */
+    void SetCheckpoint(const CheckpointCallback& callback, double interval_seconds);
+
+    /**
+     * @brief Solves a single input line, without the line terminator
+     */
+    bool SolveLine(std::string_view line, SolutionWriter& writer);
+
+    /**
+     * @brief Returns the puzzle field of an input line
+     */
+    static std::string_view GetPuzzleField(std::string_view line);
+
+    void SetSolutionCache(SolutionCache* cache) { m_solver.SetSolutionCache(cache); }
+
+    /**
+     * @brief Sets the table of boards with no solution, kept from one puzzle to the next (not owned)
+     */
+    void SetTranspositionTable(TranspositionTable* table) { m_solver.SetTranspositionTable(table); }
+
+    /**
+     * @brief Sets the budgets applied to each puzzle
+     */
+    void SetLimits(const SSolveLimits& limits) { m_solver.SetLimits(limits); }
+
+    /**
+     * @brief Sets the search engine used for each puzzle
+     */
+    void SetEngine(SSolverEngine engine) { m_solver.SetEngine(engine); }
+
+    /**
+     * @brief Hands each puzzle over to the SAT engine after this many search nodes (0 for never)
+     */
+    void SetSatFallback(uint64_t max_nodes) { m_solver.SetSatFallback(max_nodes); }
+
+    /**
+     * @brief Sets the look-ahead before each guess, on cells with up to this many candidates (0 for none)
+     */
+    void SetProbing(int max_candidates) { m_solver.SetProbing(max_candidates); }
+
+    /**
+     * @brief Sets the order in which the search tries values
+     */
+    void SetValueOrder(SValueOrder order) { m_solver.SetValueOrder(order); }
+
+    const SBatchStats& GetStats() const { return m_stats; }
+
+protected:
+
+    SudokuSolver m_solver;
+    SBatchStats m_stats;
+
+    CheckpointCallback m_onCheckpoint;
+    std::chrono::steady_clock::duration m_checkpointInterval{};
+
+    uint64_t m_rangeBegin = 0;
+    uint64_t m_rangeEnd = UINT64_MAX;
+
+    // Reused between lines, rather than allocated per puzzle
+    SBoard m_board;
+    SBoard m_solvedBoard;
+};
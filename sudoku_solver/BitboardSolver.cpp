@@ -0,0 +1,275 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "BitboardSolver.h"
+#include "SBoardTables.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+	constexpr SCellPlane CellPlane(int cell)
+	{
+		return (cell < 64) ? SCellPlane{ uint64_t(1) << cell, 0 } : SCellPlane{ 0, uint64_t(1) << (cell - 64) };
+	}
+
+	/**
+	 * @brief Cell, peer and unit masks, built at compile time from `g_boardTables`
+	 */
+	struct SPlaneTables
+	{
+		SCellPlane cells[SBoardTables::CellCount];
+		SCellPlane peers[SBoardTables::CellCount];
+		SCellPlane units[SBoardTables::UnitCount];
+		SCellPlane all;
+	};
+
+	constexpr SPlaneTables MakePlaneTables()
+	{
+		SPlaneTables t{};
+		for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+			t.cells[cell] = CellPlane(cell);
+			t.all = t.all | t.cells[cell];
+			for (auto peer : g_boardTables.peers[cell]) {
+				t.peers[cell] = t.peers[cell] | CellPlane(peer);
+			}
+		}
+		for (int unit = 0; unit < SBoardTables::UnitCount; unit++) {
+			for (auto cell : g_boardTables.cells[unit]) {
+				t.units[unit] = t.units[unit] | CellPlane(cell);
+			}
+		}
+		return t;
+	}
+
+	constexpr SPlaneTables g_planes = MakePlaneTables();
+
+	static_assert(g_planes.all.hi == (uint64_t(1) << (SBoardTables::CellCount - 64)) - 1, "81 cells");
+
+	int LowestBit(uint64_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, bits);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctzll(bits);
+#endif
+	}
+}
+
+int SCellPlane::First() const
+{
+	return (lo != 0) ? LowestBit(lo) : 64 + LowestBit(hi);
+}
+
+bool SBitBoard::FromBoard(const SBoard& board)
+{
+	for (int digit = 0; digit < BOARD_SIZE; digit++) {
+		candidates[digit] = g_planes.all;
+		placed[digit] = SCellPlane{};
+	}
+	solved = SCellPlane{};
+
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		int value = static_cast<int>(board.GetCellDirect(cell).value);
+		if ((value != 0) && !Place(cell, value - 1))
+			return false;
+	}
+	return true;
+}
+
+void SBitBoard::ToBoard(SBoard& board) const
+{
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		int value = GetValue(cell);
+		if ((value != 0) && (board.GetCellDirect(cell).value == SValueEnum::SValue_Empty))
+			board.SetCell(g_boardTables.col[cell], g_boardTables.row[cell], SCell{ static_cast<SValueEnum>(value), SStateEnum::SState_Solved });
+	}
+}
+
+bool SBitBoard::Place(int cell, int digit)
+{
+	if (!candidates[digit].Has(cell))
+		return false;
+
+	const SCellPlane& bit = g_planes.cells[cell];
+	for (auto& plane : candidates) {
+		plane = plane.Without(bit);
+	}
+	candidates[digit] = candidates[digit].Without(g_planes.peers[cell]);
+	placed[digit] |= bit;
+	solved |= bit;
+	return true;
+}
+
+int SBitBoard::GetValue(int cell) const
+{
+	for (int digit = 0; digit < BOARD_SIZE; digit++) {
+		if (placed[digit].Has(cell))
+			return digit + 1;
+	}
+	return 0;
+}
+
+bool SBitBoard::IsSolved() const
+{
+	return (solved.lo == g_planes.all.lo) && (solved.hi == g_planes.all.hi);
+}
+
+/*
+* Naked singles first, as they are found for the whole board in one pass.
+* Hidden singles are only looked for once there are no naked singles left.
+*/
+bool BitboardSolver::Propagate(SBitBoard& board)
+{
+	while (true) {
+		// Cells with at least one, and with at least two, candidates
+		SCellPlane once;
+		SCellPlane twice;
+		for (const auto& plane : board.candidates) {
+			twice |= once & plane;
+			once |= plane;
+		}
+
+		SCellPlane free = g_planes.all.Without(board.solved);
+		if (!free.Without(once).IsEmpty())
+			return false;
+
+		SCellPlane singles = once.Without(twice);
+		if (!singles.IsEmpty()) {
+			for (int digit = 0; digit < BOARD_SIZE; digit++) {
+				SCellPlane cells = singles & board.candidates[digit];
+				while (!cells.IsEmpty()) {
+					int cell = cells.First();
+					cells = cells.Without(g_planes.cells[cell]);
+
+					// Another single may have taken the value from this cell's units.
+					if (!board.Place(cell, digit))
+						return false;
+				}
+			}
+			continue;
+		}
+
+		bool has_placed = false;
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			for (const auto& unit : g_planes.units) {
+				if (!(board.placed[digit] & unit).IsEmpty())
+					continue;
+
+				SCellPlane cells = board.candidates[digit] & unit;
+				if (cells.IsEmpty())
+					return false;
+
+				if (cells.IsSingle()) {
+					board.Place(cells.First(), digit);
+					has_placed = true;
+				}
+			}
+		}
+
+		if (!has_placed)
+			return true;
+	}
+}
+
+bool BitboardSolver::Search(SBitBoard& board, SBitBoard& solution, int& steps)
+{
+	if (m_isAborted)
+		return false;
+
+	m_nodes++;
+	if (m_budget.IsSpent(m_nodes, m_abortStatus)) {
+		m_isAborted = true;
+		return false;
+	}
+
+	if (!Propagate(board))
+		return false;
+
+	if (board.IsSolved()) {
+		solution = board;
+		return true;
+	}
+
+	steps++;
+
+	// Candidate counts of every cell, as a 4-bit number across four planes.
+	SCellPlane count[4];
+	for (const auto& plane : board.candidates) {
+		SCellPlane carry = plane;
+		for (auto& bit : count) {
+			SCellPlane next = bit & carry;
+			bit = bit ^ carry;
+			carry = next;
+		}
+	}
+
+	// Branch on a free cell with the fewest candidates. Propagation leaves
+	// every free cell with at least two.
+	SCellPlane free = g_planes.all.Without(board.solved);
+	int cell = -1;
+	for (int n = 2; (n <= BOARD_SIZE) && (cell < 0); n++) {
+		SCellPlane cells = free;
+		for (int b = 0; b < 4; b++) {
+			cells = (n & (1 << b)) ? (cells & count[b]) : cells.Without(count[b]);
+		}
+		if (!cells.IsEmpty())
+			cell = cells.First();
+	}
+	if (cell < 0)
+		return false;
+
+	for (int digit = 0; digit < BOARD_SIZE; digit++) {
+		if (!board.candidates[digit].Has(cell))
+			continue;
+
+		SBitBoard child = board;
+		child.Place(cell, digit);
+		if (Search(child, solution, steps))
+			return true;
+
+		if (m_isAborted)
+			return false;
+	}
+	return false;
+}
+
+bool BitboardSolver::Solve(const SBoard& board, SBoard* board_ptr, int& steps)
+{
+	return SolveWithStatus(board, board_ptr, steps) == SSolveStatus::Solved;
+}
+
+SSolveStatus BitboardSolver::SolveWithStatus(const SBoard& board, SBoard* board_ptr, int& steps)
+{
+	m_budget.Start(m_limits);
+	m_isAborted = false;
+	m_nodes = 0;
+
+	SBitBoard start;
+	SBitBoard solution;
+	bool has_solved = start.FromBoard(board) && Search(start, solution, steps);
+
+	if (m_isAborted) {
+		if (board_ptr) {
+			board_ptr->ClearBoard();
+		}
+		return m_abortStatus;
+	}
+
+	if (board_ptr) {
+		if (has_solved) {
+			*board_ptr = board;
+			solution.ToBoard(*board_ptr);
+		}
+		else {
+			board_ptr->ClearBoard();
+		}
+	}
+	return has_solved ? SSolveStatus::Solved : SSolveStatus::Unsolved;
+}
@@ -0,0 +1,135 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SudokuSolver.h"
+#include <cstdint>
+
+/**
+ * @brief A set of board cells as one 128-bit word. Bit n is cell n, in row
+ *        order, so cells 64 - 80 are in the high half.
+ */
+struct SCellPlane
+{
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    constexpr bool IsEmpty() const { return (lo | hi) == 0; }
+    constexpr bool Has(int cell) const { return (cell < 64) ? ((lo >> cell) & 1) : ((hi >> (cell - 64)) & 1); }
+    constexpr bool IsSingle() const { return (lo == 0) ? ((hi != 0) && ((hi & (hi - 1)) == 0)) : ((hi == 0) && ((lo & (lo - 1)) == 0)); }
+
+    /**
+     * @brief Returns the lowest cell in the set, which must not be empty
+     */
+    int First() const;
+
+    constexpr SCellPlane operator&(const SCellPlane& other) const { return { lo & other.lo, hi & other.hi }; }
+    constexpr SCellPlane operator|(const SCellPlane& other) const { return { lo | other.lo, hi | other.hi }; }
+    constexpr SCellPlane operator^(const SCellPlane& other) const { return { lo ^ other.lo, hi ^ other.hi }; }
+    constexpr SCellPlane& operator|=(const SCellPlane& other) { lo |= other.lo; hi |= other.hi; return *this; }
+
+    /**
+     * @brief The cells of this set that are not in the other
+     */
+    constexpr SCellPlane Without(const SCellPlane& other) const { return { lo & ~other.lo, hi & ~other.hi }; }
+};
+
+/**
+ * @brief A board as digit planes: for each value, the cells it can still go in
+ *
+ * Placing a value clears its cell from every plane, and its peers from the
+ * plane of the value, which is ten 128-bit AND-NOTs with a precomputed peer
+ * mask. Placed values are kept as planes of their own.
+ */
+struct SBitBoard
+{
+    SCellPlane candidates[BOARD_SIZE];  // plane d: free cells that can take value d + 1
+    SCellPlane placed[BOARD_SIZE];      // plane d: cells holding value d + 1
+    SCellPlane solved;                  // cells holding any value
+
+    /**
+     * @brief Loads the values of the board
+     * @return False if two values clash
+     */
+    bool FromBoard(const SBoard& board);
+
+    /**
+     * @brief Writes the values into the free cells of the board, as solved
+     */
+    void ToBoard(SBoard& board) const;
+
+    /**
+     * @brief Places value (digit + 1) in the cell
+     * @return False if the value cannot go there
+     */
+    bool Place(int cell, int digit);
+
+    /**
+     * @return The value of the cell, 0 if it is free
+     */
+    int GetValue(int cell) const;
+
+    bool IsSolved() const;
+};
+
+/**
+ * @class BitboardSolver
+ * @brief Solves a board held as digit planes (`SBitBoard`)
+ *
+ * Naked singles are found for all cells at once, by counting the candidates of
+ * every cell across the planes with bit-sliced adds. Hidden singles come from
+ * each plane masked by each unit. The search branches on a cell with the
+ * fewest candidates, found from the same counts, and tries its values in
+ * ascending order, so results are reproducible.
+ *
+ * The same budgets as `SudokuSolver` apply. The transposition table and the
+ * solution cache are not used.
+ */
+class BitboardSolver
+{
+public:
+
+    /**
+     * @brief Solves a Sudoku board
+     * @param board The Sudoku board to solve. It is not changed.
+     * @param board_ptr Receives the solved board (optional)
+     * @param steps The number of steps taken to solve the board
+     * @return True if the board is solved, false otherwise
+     */
+    bool Solve(const SBoard& board, SBoard* board_ptr, int& steps);
+
+    /**
+     * @brief As above, but reports why a board was not solved
+     */
+    SSolveStatus SolveWithStatus(const SBoard& board, SBoard* board_ptr, int& steps);
+
+    void SetLimits(const SSolveLimits& limits) { m_limits = limits; }
+
+    const SSolveLimits& GetLimits() const { return m_limits; }
+
+    /**
+     * @brief Number of search nodes visited by the last solve
+     */
+    uint64_t GetNodeCount() const { return m_nodes; }
+
+    /**
+     * @brief Places naked and hidden singles until there are none left
+     * @return False if the board has no solution
+     */
+    static bool Propagate(SBitBoard& board);
+
+protected:
+
+    SSolveLimits m_limits;
+
+    // State of the current solve
+    SSolveBudget m_budget;
+    SSolveStatus m_abortStatus = SSolveStatus::Unsolved;
+    bool m_isAborted = false;
+    uint64_t m_nodes = 0;
+
+    bool Search(SBitBoard& board, SBitBoard& solution, int& steps);
+};
@@ -0,0 +1,80 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "CheckpointFile.h"
+#include <fstream>
+#include <filesystem>
+#include <cstdlib>
+
+void CheckpointFile::Clear()
+{
+	m_values.clear();
+	m_lines.clear();
+}
+
+std::string CheckpointFile::GetValue(const std::string& key) const
+{
+	auto it = m_values.find(key);
+	return (it == m_values.end()) ? std::string() : it->second;
+}
+
+uint64_t CheckpointFile::GetNumber(const std::string& key, uint64_t default_value /*= 0*/) const
+{
+	auto it = m_values.find(key);
+	if ((it == m_values.end()) || it->second.empty())
+		return default_value;
+
+	return std::strtoull(it->second.c_str(), nullptr, 10);
+}
+
+bool CheckpointFile::Save(const std::string& path) const
+{
+	std::string temp_path = path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		for (const auto& [key, value] : m_values) {
+			file << key << '=' << value << '\n';
+		}
+		for (const auto& line : m_lines) {
+			file << line << '\n';
+		}
+
+		file.flush();
+		if (!file)
+			return false;
+	}
+
+	// rename() replaces the old checkpoint in one step.
+	std::error_code ec;
+	std::filesystem::rename(temp_path, path, ec);
+	return !ec;
+}
+
+bool CheckpointFile::Load(const std::string& path)
+{
+	Clear();
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		if (!line.empty() && (line.back() == '\r'))
+			line.pop_back();
+
+		auto equals = line.find('=');
+		if (equals != std::string::npos) {
+			m_values[line.substr(0, equals)] = line.substr(equals + 1);
+		}
+		else if (!line.empty()) {
+			m_lines.push_back(line);
+		}
+	}
+	return true;
+}
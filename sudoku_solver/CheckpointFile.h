@@ -0,0 +1,57 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+/**
+ * @class CheckpointFile
+ * @brief The saved progress of a long run, from which it can be resumed
+ *
+ * The file is text. It holds `key=value` lines, followed by any number of
+ * plain lines (the search frontier of an enumeration, one layout per line).
+ *
+ * A checkpoint is written to a temporary file, which then replaces the old
+ * one. So an interrupted save leaves the previous checkpoint in place.
+ */
+class CheckpointFile
+{
+public:
+
+    void Clear();
+
+    void SetValue(const std::string& key, const std::string& value) { m_values[key] = value; }
+    void SetNumber(const std::string& key, uint64_t value) { m_values[key] = std::to_string(value); }
+
+    /**
+     * @brief Returns the value of the key, or an empty string if there is none
+     */
+    std::string GetValue(const std::string& key) const;
+
+    /**
+     * @brief Returns the value of the key, or the default if there is none
+     */
+    uint64_t GetNumber(const std::string& key, uint64_t default_value = 0) const;
+
+    std::vector<std::string>& GetLines() { return m_lines; }
+    const std::vector<std::string>& GetLines() const { return m_lines; }
+
+    /**
+     * @brief Writes the checkpoint, replacing any earlier one
+     * @return False if the file could not be written. The earlier checkpoint is then kept.
+     */
+    bool Save(const std::string& path) const;
+
+    bool Load(const std::string& path);
+
+protected:
+
+    std::map<std::string, std::string> m_values;
+    std::vector<std::string> m_lines;
+};
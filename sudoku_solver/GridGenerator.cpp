@@ -0,0 +1,168 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "GridGenerator.h"
+#include "SBoardTables.h"
+#include <random>
+
+GridGenerator::GridGenerator(uint64_t seed)
+	: m_state(seed)
+{
+	Reseed();
+}
+
+GridGenerator::GridGenerator()
+	: GridGenerator((static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}())
+{
+}
+
+uint64_t GridGenerator::NextRandom()
+{
+	uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+uint32_t GridGenerator::Next(uint32_t bound)
+{
+	// Scales the top 32 bits, rather than dividing. The bias is negligible for
+	// the small bounds used here.
+	return static_cast<uint32_t>(((NextRandom() >> 32) * bound) >> 32);
+}
+
+/*
+* Rows are permuted within their band and bands as a whole, and the same for
+* columns and stacks. Digits are relabelled freely.
+*/
+void GridGenerator::RandomTransform(SBoardTransform& transform)
+{
+	int bands[BLOCK_SIZE] = { 0, 1, 2 };
+	int stacks[BLOCK_SIZE] = { 0, 1, 2 };
+	Shuffle(bands, BLOCK_SIZE);
+	Shuffle(stacks, BLOCK_SIZE);
+
+	for (int b = 0; b < BLOCK_SIZE; b++) {
+		int rows[BLOCK_SIZE] = { 0, 1, 2 };
+		int cols[BLOCK_SIZE] = { 0, 1, 2 };
+		Shuffle(rows, BLOCK_SIZE);
+		Shuffle(cols, BLOCK_SIZE);
+		for (int i = 0; i < BLOCK_SIZE; i++) {
+			transform.rows[b * BLOCK_SIZE + i] = bands[b] * BLOCK_SIZE + rows[i];
+			transform.cols[b * BLOCK_SIZE + i] = stacks[b] * BLOCK_SIZE + cols[i];
+		}
+	}
+
+	transform.digits[0] = 0;
+	for (int v = 1; v <= BOARD_SIZE; v++) {
+		transform.digits[v] = v;
+	}
+	Shuffle(transform.digits.data() + 1, BOARD_SIZE);
+
+	transform.transpose = (Next(2) != 0);
+}
+
+void GridGenerator::Apply(const Grid& source, const SBoardTransform& transform, Grid& target)
+{
+	// Source offsets of each output row and column. Transposing swaps which
+	// of them steps by a whole row.
+	int row_step = transform.transpose ? 1 : BOARD_SIZE;
+	int col_step = transform.transpose ? BOARD_SIZE : 1;
+	int row_offsets[BOARD_SIZE];
+	int col_offsets[BOARD_SIZE];
+	uint8_t digits[BOARD_SIZE + 1];
+	for (int i = 0; i < BOARD_SIZE; i++) {
+		row_offsets[i] = transform.rows[i] * row_step;
+		col_offsets[i] = transform.cols[i] * col_step;
+	}
+	for (int v = 0; v <= BOARD_SIZE; v++) {
+		digits[v] = static_cast<uint8_t>(transform.digits[v]);
+	}
+
+	for (int r = 0; r < BOARD_SIZE; r++) {
+		const uint8_t* row = source + row_offsets[r];
+		uint8_t* out = target + r * BOARD_SIZE;
+		for (int c = 0; c < BOARD_SIZE; c++) {
+			out[c] = digits[row[col_offsets[c]]];
+		}
+	}
+}
+
+void GridGenerator::Generate(Grid& grid)
+{
+	if (m_reseedInterval && (m_generated > 0) && (m_generated % m_reseedInterval == 0))
+		Reseed();
+	m_generated++;
+
+	SBoardTransform transform;
+	RandomTransform(transform);
+	Apply(m_seedGrid, transform, grid);
+}
+
+void GridGenerator::Generate(SBoard& board)
+{
+	Grid grid;
+	Generate(grid);
+	for (int i = 0; i < SBoardTables::CellCount; i++) {
+		auto& cell = board.GetCellDirect(i);
+		cell.value = static_cast<SValueEnum>(grid[i]);
+		cell.state = SStateEnum::SState_Fixed;
+	}
+	board.UpdateHash();
+}
+
+void GridGenerator::Fill(Grid& grid)
+{
+	uint16_t rows[BOARD_SIZE] = {};
+	uint16_t cols[BOARD_SIZE] = {};
+	uint16_t blocks[BOARD_SIZE] = {};
+
+	// An empty board always has a solution, so this cannot fail.
+	FillFrom(grid, 0, rows, cols, blocks);
+}
+
+void GridGenerator::Reseed()
+{
+	Fill(m_seedGrid);
+}
+
+/*
+* Fills the cells in row order, trying the free values of each cell in a
+* random order. Values use bit (value - 1) of the unit masks.
+*/
+bool GridGenerator::FillFrom(Grid& grid, int index, uint16_t* rows, uint16_t* cols, uint16_t* blocks)
+{
+	if (index == SBoardTables::CellCount)
+		return true;
+
+	int row = g_boardTables.row[index];
+	int col = g_boardTables.col[index];
+	int block = g_boardTables.block[index];
+	unsigned int used = rows[row] | cols[col] | blocks[block];
+
+	int values[BOARD_SIZE];
+	int count = 0;
+	for (int v = 1; v <= BOARD_SIZE; v++) {
+		if (!(used & (1u << (v - 1))))
+			values[count++] = v;
+	}
+	Shuffle(values, count);
+
+	for (int i = 0; i < count; i++) {
+		uint16_t bit = static_cast<uint16_t>(1u << (values[i] - 1));
+		rows[row] |= bit;
+		cols[col] |= bit;
+		blocks[block] |= bit;
+		grid[index] = static_cast<uint8_t>(values[i]);
+
+		if (FillFrom(grid, index + 1, rows, cols, blocks))
+			return true;
+
+		rows[row] &= ~bit;
+		cols[col] &= ~bit;
+		blocks[block] &= ~bit;
+	}
+	return false;
+}
@@ -0,0 +1,111 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoard.h"
+#include "SBoardSymmetry.h"
+#include <cstdint>
+
+/**
+ * @class GridGenerator
+ * @brief Produces random solved grids
+ *
+ * Grids are made by applying a random `SBoardTransform` to a seed grid. This
+ * takes a few random numbers and one pass over the 81 cells, with no search.
+ *
+ * Transforms only reach the grids equivalent to the seed grid. For more
+ * variety, `Reseed()` replaces the seed grid with one made by a randomised
+ * search from an empty board. This can be done every so many grids with
+ * `SetReseedInterval()`.
+ *
+ * The same seed always gives the same sequence of grids, on any platform. The
+ * random numbers come from SplitMix64, which is much cheaper per number than
+ * `std::mt19937_64`, and a transform takes about 25 of them.
+ * A generator must not be shared between threads without locking.
+ */
+class GridGenerator
+{
+public:
+
+    using Grid = uint8_t[BOARD_SIZE * BOARD_SIZE];   // values 1 - 9, in row order
+
+    /**
+     * @param seed Seed of the random sequence
+     */
+    explicit GridGenerator(uint64_t seed);
+
+    /**
+     * @brief As above, with a seed taken from `std::random_device`
+     */
+    GridGenerator();
+
+    /**
+     * @brief Writes a new solved grid, transformed from the seed grid
+     */
+    void Generate(Grid& grid);
+
+    /**
+     * @brief As above, into a board. All the cells are fixed.
+     */
+    void Generate(SBoard& board);
+
+    /**
+     * @brief Writes a new solved grid, by a randomised search from an empty board
+     *
+     * Much slower than `Generate()`, but not limited to one family of grids.
+     */
+    void Fill(Grid& grid);
+
+    /**
+     * @brief Replaces the seed grid with a new one from `Fill()`
+     */
+    void Reseed();
+
+    /**
+     * @brief Reseeds after every `count` grids generated, 0 = never (default)
+     */
+    void SetReseedInterval(uint64_t count) { m_reseedInterval = count; }
+
+    /**
+     * @brief Makes a random transform, keeping the validity of any grid
+     */
+    void RandomTransform(SBoardTransform& transform);
+
+    /**
+     * @brief Applies the transform to a grid, as `SBoardSymmetry::Apply()`
+     */
+    static void Apply(const Grid& source, const SBoardTransform& transform, Grid& target);
+
+protected:
+
+    uint64_t m_state;               // SplitMix64
+    Grid m_seedGrid;
+    uint64_t m_reseedInterval = 0;
+    uint64_t m_generated = 0;
+
+    uint64_t NextRandom();
+
+    /**
+     * @brief Returns a random number below `bound`
+     */
+    uint32_t Next(uint32_t bound);
+
+    /**
+     * @brief Shuffles the values, without the platform dependent `std::shuffle()`
+     */
+    template <typename T>
+    void Shuffle(T* values, int count)
+    {
+        for (int i = count - 1; i > 0; i--) {
+            int j = static_cast<int>(Next(static_cast<uint32_t>(i + 1)));
+            T value = values[i];
+            values[i] = values[j];
+            values[j] = value;
+        }
+    }
+
+    bool FillFrom(Grid& grid, int index, uint16_t* rows, uint16_t* cols, uint16_t* blocks);
+};
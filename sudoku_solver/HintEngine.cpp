@@ -0,0 +1,271 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "HintEngine.h"
+#include "SolverSession.h"
+#include "SBoardTables.h"
+
+namespace {
+
+	constexpr int CELL_COUNT = SBoardTables::CellCount;
+	constexpr int UNIT_COUNT = SBoardTables::UnitCount;
+
+	SPos ToPos(int cell)
+	{
+		return SPos(g_boardTables.col[cell], g_boardTables.row[cell]);
+	}
+
+	SUnit ToUnit(int unit)
+	{
+		SUnit u;
+		if (unit < SBoardTables::FirstColumnUnit) {
+			u.kind = SUnit::Kind::Row;
+			u.index = unit;
+		}
+		else if (unit < SBoardTables::FirstBlockUnit) {
+			u.kind = SUnit::Kind::Column;
+			u.index = unit - SBoardTables::FirstColumnUnit;
+		}
+		else {
+			u.kind = SUnit::Kind::Block;
+			u.index = unit - SBoardTables::FirstBlockUnit;
+		}
+		return u;
+	}
+
+	bool IsInUnit(int cell, int unit)
+	{
+		const uint8_t* units = g_boardTables.units[cell];
+		return (units[0] == unit) || (units[1] == unit) || (units[2] == unit);
+	}
+
+	void SetSingle(SHint& hint, SHintTechnique technique, int cell, int digit)
+	{
+		hint.technique = technique;
+		hint.position = ToPos(cell);
+		hint.value = static_cast<SValueEnum>(digit + 1);
+	}
+
+	/*
+	* Returns the cells of the unit that have the digit as a candidate.
+	*/
+	int FindPlaces(const uint16_t* candidates, int unit, int digit, int* places)
+	{
+		int count = 0;
+		for (int cell : g_boardTables.cells[unit]) {
+			if (candidates[cell] & (1 << digit))
+				places[count++] = cell;
+		}
+		return count;
+	}
+
+	/*
+	* Removes `mask` from the cells of `unit`, other than those in `keep_unit`
+	* (or `keep_cells`). Returns true if anything would be removed.
+	*/
+	bool CollectEliminations(const uint16_t* candidates, int unit, uint16_t mask, int keep_unit, const int* keep_cells, int keep_count, SHint& hint)
+	{
+		hint.eliminations.clear();
+		for (int cell : g_boardTables.cells[unit]) {
+			if ((keep_unit >= 0) && IsInUnit(cell, keep_unit))
+				continue;
+
+			bool keep = false;
+			for (int k = 0; k < keep_count; k++) {
+				keep |= (keep_cells[k] == cell);
+			}
+			if (keep)
+				continue;
+
+			uint16_t removed = candidates[cell] & mask;
+			for (int digit = 0; digit < BOARD_SIZE; digit++) {
+				if (removed & (1 << digit))
+					hint.eliminations.push_back({ ToPos(cell), static_cast<SValueEnum>(digit + 1) });
+			}
+		}
+		return !hint.eliminations.empty();
+	}
+}
+
+bool HintEngine::FindHint(const SBoard& board, SHint& hint) const
+{
+	uint8_t values[CELL_COUNT];
+	uint16_t used[UNIT_COUNT] = {};
+	uint16_t candidates[CELL_COUNT];
+
+	for (int cell = 0; cell < CELL_COUNT; cell++) {
+		values[cell] = static_cast<uint8_t>(board.GetCell(g_boardTables.col[cell], g_boardTables.row[cell]).value);
+		if (values[cell] == 0)
+			continue;
+
+		uint16_t bit = static_cast<uint16_t>(1 << (values[cell] - 1));
+		for (int unit : g_boardTables.units[cell]) {
+			// No hints for a board with clashing values
+			if (used[unit] & bit)
+				return false;
+			used[unit] |= bit;
+		}
+	}
+
+	for (int cell = 0; cell < CELL_COUNT; cell++) {
+		const uint8_t* units = g_boardTables.units[cell];
+		candidates[cell] = (values[cell] != 0) ? 0 : (SUnitMasks::AllCandidates & ~(used[units[0]] | used[units[1]] | used[units[2]]));
+	}
+
+	return FindHint(values, candidates, hint);
+}
+
+bool HintEngine::FindHint(const SolverSession& session, SHint& hint) const
+{
+	if (session.IsContradiction())
+		return false;
+
+	uint8_t values[CELL_COUNT];
+	uint16_t candidates[CELL_COUNT];
+	for (int cell = 0; cell < CELL_COUNT; cell++) {
+		values[cell] = static_cast<uint8_t>(session.GetValue(ToPos(cell)));
+		candidates[cell] = session.Candidates(ToPos(cell));
+	}
+
+	return FindHint(values, candidates, hint);
+}
+
+bool HintEngine::FindHint(const uint8_t* values, const uint16_t* candidates, SHint& hint) const
+{
+	hint = SHint{};
+	int places[BOARD_SIZE];
+
+	for (int cell = 0; cell < CELL_COUNT; cell++) {
+		if ((values[cell] == 0) && (candidates[cell] == 0))
+			return false;
+	}
+
+	// Hidden single within a block
+	for (int unit = SBoardTables::FirstBlockUnit; unit < UNIT_COUNT; unit++) {
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			if (FindPlaces(candidates, unit, digit, places) == 1) {
+				SetSingle(hint, SHintTechnique::HiddenSingleBlock, places[0], digit);
+				hint.units.push_back(ToUnit(unit));
+				return true;
+			}
+		}
+	}
+
+	// Naked single
+	for (int cell = 0; cell < CELL_COUNT; cell++) {
+		if ((values[cell] == 0) && (CountBits(candidates[cell]) == 1)) {
+			int digit = 0;
+			while (!(candidates[cell] & (1 << digit)))
+				digit++;
+
+			SetSingle(hint, SHintTechnique::NakedSingle, cell, digit);
+			for (int unit : g_boardTables.units[cell]) {
+				hint.units.push_back(ToUnit(unit));
+			}
+			return true;
+		}
+	}
+
+	// Hidden single within a row or column
+	for (int unit = 0; unit < SBoardTables::FirstBlockUnit; unit++) {
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			if (FindPlaces(candidates, unit, digit, places) == 1) {
+				SetSingle(hint, SHintTechnique::HiddenSingleLine, places[0], digit);
+				hint.units.push_back(ToUnit(unit));
+				return true;
+			}
+		}
+	}
+
+	// Pointing: a digit of a block confined to one row/column of the block
+	// can be removed from the rest of that row/column.
+	for (int unit = SBoardTables::FirstBlockUnit; unit < UNIT_COUNT; unit++) {
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			int count = FindPlaces(candidates, unit, digit, places);
+			if (count < 2)
+				continue;
+
+			for (int line : { 0, 1 }) {
+				int line_unit = g_boardTables.units[places[0]][line];
+				bool is_confined = true;
+				for (int k = 1; k < count; k++) {
+					is_confined &= (g_boardTables.units[places[k]][line] == line_unit);
+				}
+
+				if (is_confined && CollectEliminations(candidates, line_unit, static_cast<uint16_t>(1 << digit), unit, nullptr, 0, hint)) {
+					hint.technique = SHintTechnique::PointingCandidates;
+					hint.value = static_cast<SValueEnum>(digit + 1);
+					hint.units = { ToUnit(unit), ToUnit(line_unit) };
+					return true;
+				}
+			}
+		}
+	}
+
+	// Claiming: a digit of a row/column confined to one block can be removed
+	// from the rest of that block.
+	for (int unit = 0; unit < SBoardTables::FirstBlockUnit; unit++) {
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			int count = FindPlaces(candidates, unit, digit, places);
+			if (count < 2)
+				continue;
+
+			int block_unit = g_boardTables.units[places[0]][2];
+			bool is_confined = true;
+			for (int k = 1; k < count; k++) {
+				is_confined &= (g_boardTables.units[places[k]][2] == block_unit);
+			}
+
+			if (is_confined && CollectEliminations(candidates, block_unit, static_cast<uint16_t>(1 << digit), unit, nullptr, 0, hint)) {
+				hint.technique = SHintTechnique::ClaimingCandidates;
+				hint.value = static_cast<SValueEnum>(digit + 1);
+				hint.units = { ToUnit(unit), ToUnit(block_unit) };
+				return true;
+			}
+		}
+	}
+
+	// Naked pair: two cells of a unit with the same two candidates. Those two
+	// digits can be removed from the rest of the unit.
+	for (int unit = 0; unit < UNIT_COUNT; unit++) {
+		const uint8_t* cells = g_boardTables.cells[unit];
+		for (int i = 0; i < BOARD_SIZE; i++) {
+			uint16_t mask = candidates[cells[i]];
+			if ((values[cells[i]] != 0) || (CountBits(mask) != 2))
+				continue;
+
+			for (int j = i + 1; j < BOARD_SIZE; j++) {
+				if ((values[cells[j]] != 0) || (candidates[cells[j]] != mask))
+					continue;
+
+				int pair[2] = { cells[i], cells[j] };
+				if (CollectEliminations(candidates, unit, mask, -1, pair, 2, hint)) {
+					hint.technique = SHintTechnique::NakedPair;
+					hint.position = ToPos(cells[i]);
+					hint.units = { ToUnit(unit) };
+					return true;
+				}
+			}
+		}
+	}
+
+	hint = SHint{};
+	return false;
+}
+
+const wchar_t* HintEngine::GetTechniqueName(SHintTechnique technique)
+{
+	switch (technique) {
+	case SHintTechnique::HiddenSingleBlock:  return L"Hidden single (block)";
+	case SHintTechnique::NakedSingle:        return L"Naked single";
+	case SHintTechnique::HiddenSingleLine:   return L"Hidden single (row/column)";
+	case SHintTechnique::PointingCandidates: return L"Pointing candidates";
+	case SHintTechnique::ClaimingCandidates: return L"Claiming candidates";
+	case SHintTechnique::NakedPair:          return L"Naked pair";
+	default:
+		break;
+	}
+	return L"None";
+}
@@ -0,0 +1,92 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoard.h"
+#include <vector>
+#include <cstdint>
+
+class SolverSession;
+
+/**
+ * @brief Logical techniques used by hints, cheapest first
+ */
+enum class SHintTechnique {
+    None,
+    HiddenSingleBlock,      // only one cell of a block can take the value
+    NakedSingle,            // a cell has only one candidate left
+    HiddenSingleLine,       // only one cell of a row/column can take the value
+    PointingCandidates,     // a value of a block is confined to one row/column
+    ClaimingCandidates,     // a value of a row/column is confined to one block
+    NakedPair               // two cells of a unit share the same two candidates
+};
+
+/**
+ * @brief A row, column or block of the board
+ */
+struct SUnit
+{
+    enum class Kind { Row, Column, Block };
+
+    Kind kind = Kind::Row;
+    int index = 0;          // 0 - 8, blocks are numbered as for `SBoard::GetBlock()`
+};
+
+/**
+ * @brief A single logical deduction
+ *
+ * Singles set `position` and `value`, applied with `SolverSession::Place()`.
+ * The other techniques only remove candidates, which are listed in
+ * `eliminations` and applied with `SolverSession::Eliminate()`.
+ */
+struct SHint
+{
+    SHintTechnique technique = SHintTechnique::None;
+    SPos position;
+    SValueEnum value = SValueEnum::SValue_Empty;
+    std::vector<std::pair<SPos, SValueEnum>> eliminations;
+    std::vector<SUnit> units;   // the units the deduction is based on
+};
+
+/**
+ * @class HintEngine
+ * @brief Finds the cheapest next logical step for a board
+ *
+ * Techniques are tried in the order of `SHintTechnique`, starting with the
+ * block hidden singles that `SudokuSolver::FindByElimination()` uses. No
+ * guessing is ever done, so a hint either comes straight from the candidates
+ * or is not given at all.
+ */
+class HintEngine
+{
+public:
+
+    /**
+     * @brief Finds the next deduction for the board
+     * @param board The board, candidates are derived from the cell values
+     * @param hint Receives the deduction
+     * @return False if the board is contradictory, complete, or needs a
+     *         technique beyond those listed in `SHintTechnique`
+     */
+    bool FindHint(const SBoard& board, SHint& hint) const;
+
+    /**
+     * @brief As above, using the candidates already kept by the session
+     *
+     * These include the eliminations of earlier hints, so once those are
+     * applied the next hint moves on.
+     */
+    bool FindHint(const SolverSession& session, SHint& hint) const;
+
+    /**
+     * @brief Returns a display name for the technique
+     */
+    static const wchar_t* GetTechniqueName(SHintTechnique technique);
+
+protected:
+
+    bool FindHint(const uint8_t* values, const uint16_t* candidates, SHint& hint) const;
+};
@@ -0,0 +1,111 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "LineReader.h"
+#include <cstring>
+
+LineReader::LineReader(size_t block_size /*= DEFAULT_BLOCK_SIZE*/)
+	: m_buffer(block_size ? block_size : DEFAULT_BLOCK_SIZE)
+{
+}
+
+LineReader::~LineReader()
+{
+	Close();
+}
+
+bool LineReader::Open(const std::string& path)
+{
+	Close();
+	m_file = std::fopen(path.c_str(), "rb");
+	m_ownsFile = true;
+	return (m_file != nullptr);
+}
+
+void LineReader::Attach(FILE* file)
+{
+	Close();
+	m_file = file;
+	m_ownsFile = false;
+}
+
+void LineReader::Close()
+{
+	if (m_ownsFile && (m_file != nullptr))
+		std::fclose(m_file);
+
+	m_file = nullptr;
+	m_ownsFile = false;
+	m_isEnd = false;
+	m_start = 0;
+	m_end = 0;
+	m_lineNumber = 0;
+	m_offset = 0;
+	m_limit = UINT64_MAX;
+}
+
+bool LineReader::Seek(uint64_t offset, uint64_t line_number)
+{
+	if (m_file == nullptr)
+		return false;
+
+#ifdef _WIN32
+	if (_fseeki64(m_file, static_cast<__int64>(offset), SEEK_SET) != 0)
+		return false;
+#else
+	if (fseeko(m_file, static_cast<off_t>(offset), SEEK_SET) != 0)
+		return false;
+#endif
+
+	m_isEnd = false;
+	m_start = 0;
+	m_end = 0;
+	m_offset = offset;
+	m_lineNumber = line_number;
+	return true;
+}
+
+bool LineReader::ReadLine(std::string_view& line)
+{
+	if ((m_file == nullptr) || (GetOffset() >= m_limit))
+		return false;
+
+	size_t searched = m_start;
+	while (true) {
+		auto newline = static_cast<const char*>(std::memchr(m_buffer.data() + searched, '\n', m_end - searched));
+		if (newline != nullptr) {
+			size_t length = static_cast<size_t>(newline - (m_buffer.data() + m_start));
+			line = std::string_view(m_buffer.data() + m_start, length);
+			m_start += length + 1;
+			m_lineNumber++;
+			return true;
+		}
+
+		// The last line need not be terminated.
+		if (m_isEnd) {
+			if (m_start == m_end)
+				return false;
+
+			line = std::string_view(m_buffer.data() + m_start, m_end - m_start);
+			m_start = m_end;
+			m_lineNumber++;
+			return true;
+		}
+
+		// Move the partial line to the front, and read the next block after it.
+		size_t partial = m_end - m_start;
+		std::memmove(m_buffer.data(), m_buffer.data() + m_start, partial);
+		m_start = 0;
+		m_end = partial;
+		searched = partial;
+		if (m_end == m_buffer.size())
+			m_buffer.resize(m_buffer.size() * 2);
+
+		size_t count = std::fread(m_buffer.data() + m_end, 1, m_buffer.size() - m_end, m_file);
+		m_end += count;
+		m_offset += count;
+		m_isEnd = (count == 0);
+	}
+}
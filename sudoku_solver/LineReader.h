@@ -0,0 +1,84 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+/**
+ * @class LineReader
+ * @brief Reads a stream in large blocks, and hands out its lines in place
+ *
+ * Lines are returned as views into the reader's buffer, which stay valid until
+ * the next call to `ReadLine()`. Nothing is copied or allocated per line.
+ */
+class LineReader
+{
+public:
+
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+    explicit LineReader(size_t block_size = DEFAULT_BLOCK_SIZE);
+    ~LineReader();
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Reads from an already open stream (e.g. stdin), which is not closed
+     */
+    void Attach(FILE* file);
+
+    void Close();
+
+    /**
+     * @brief Continues reading from the given offset of the file
+     * @param offset A value from `GetOffset()`, the start of a line
+     * @param line_number The line number at that offset
+     * @return False if the stream cannot seek (e.g. stdin)
+     */
+    bool Seek(uint64_t offset, uint64_t line_number);
+
+    /**
+     * @brief Stops at the first line that starts at or after the offset
+     */
+    void SetLimit(uint64_t offset) { m_limit = offset; }
+
+    /**
+     * @brief Returns the next line, without the '\n'. A '\r' is left in place.
+     * @return False at the end of the input
+     */
+    bool ReadLine(std::string_view& line);
+
+    /**
+     * @brief Number of lines returned so far
+     */
+    uint64_t GetLineNumber() const { return m_lineNumber; }
+
+    /**
+     * @brief Offset of the next line in the input
+     */
+    uint64_t GetOffset() const { return m_offset - (m_end - m_start); }
+
+    bool HasFailed() const { return (m_file != nullptr) && std::ferror(m_file); }
+
+protected:
+
+    FILE* m_file = nullptr;
+    bool m_ownsFile = false;
+    bool m_isEnd = false;
+    std::vector<char> m_buffer;
+    size_t m_start = 0;         // unread data is [m_start, m_end)
+    size_t m_end = 0;
+    uint64_t m_lineNumber = 0;
+    uint64_t m_offset = 0;      // bytes read from the stream, up to m_end
+    uint64_t m_limit = UINT64_MAX;
+};
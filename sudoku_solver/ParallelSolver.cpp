@@ -0,0 +1,262 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "ParallelSolver.h"
+#include "TranspositionTable.h"
+
+
+ParallelSolver::ParallelSolver(int thread_count /*= 0*/)
+{
+	if (thread_count <= 0)
+		thread_count = static_cast<int>(std::thread::hardware_concurrency());
+	if (thread_count <= 0)
+		thread_count = 1;
+
+	for (int i = 0; i < thread_count; i++) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		m_workers[i]->thread = std::thread(&ParallelSolver::RunWorker, this, i);
+	}
+}
+
+ParallelSolver::~ParallelSolver()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_wakeLock);
+		m_exit = true;
+	}
+	m_wake.notify_all();
+
+	for (auto& worker : m_workers) {
+		worker->thread.join();
+	}
+}
+
+bool ParallelSolver::Solve(SBoard& board, SBoard* board_ptr, int& steps)
+{
+	return SolveWithStatus(board, board_ptr, steps) == SSolveStatus::Solved;
+}
+
+SSolveStatus ParallelSolver::SolveWithStatus(SBoard& board, SBoard* board_ptr, int& steps)
+{
+	m_nodes = 0;
+	// Most boards never get as far as a search.
+	SudokuSolver solver;
+	if (solver.SolveBoardByElimination(board, steps)) {
+		if (board_ptr) {
+			*board_ptr = board;
+		}
+		return SSolveStatus::Solved;
+	}
+
+	m_budget.Start(m_limits);
+	m_cancel = false;
+	m_isSolved = false;
+	m_isAborted = false;
+	for (auto& worker : m_workers) {
+		worker->steps = 0;
+	}
+
+	PushTask(*m_workers[0], Task{ board, 0 });
+
+	// Wait for all tasks to finish, or be dropped once cancelled, so nothing
+	// is left over for the next call.
+	{
+		std::unique_lock<std::mutex> guard(m_wakeLock);
+		m_done.wait(guard, [this] { return m_pending == 0; });
+	}
+
+	for (auto& worker : m_workers) {
+		steps += worker->steps;
+	}
+
+	if (m_isSolved && board_ptr) {
+		*board_ptr = m_result;
+	}
+
+	if (m_isSolved)
+		return SSolveStatus::Solved;
+	return m_isAborted ? m_abortStatus : SSolveStatus::Unsolved;
+}
+
+void ParallelSolver::RunWorker(size_t index)
+{
+	Worker& worker = *m_workers[index];
+
+	while (true) {
+		Task task;
+		if (TakeTask(index, task)) {
+			bool is_shared = false;
+			if (!m_cancel)
+				Search(worker, task.board, task.depth, is_shared);
+			FinishTask();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(m_wakeLock);
+		m_idle++;
+		m_wake.wait(guard, [this] { return m_exit || m_queued > 0; });
+		m_idle--;
+
+		if (m_exit)
+			return;
+	}
+}
+
+/*
+* Takes the newest task of our own deque, which keeps the working set small,
+* or else the oldest task of another worker, which is likely the biggest.
+*/
+bool ParallelSolver::TakeTask(size_t index, Task& task)
+{
+	for (size_t n = 0; n < m_workers.size(); n++) {
+		Worker& victim = *m_workers[(index + n) % m_workers.size()];
+
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (victim.tasks.empty())
+			continue;
+
+		if (n == 0) {
+			task = std::move(victim.tasks.back());
+			victim.tasks.pop_back();
+		}
+		else {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+		}
+		m_queued--;
+		return true;
+	}
+	return false;
+}
+
+void ParallelSolver::PushTask(Worker& worker, Task&& task)
+{
+	m_pending++;
+	{
+		std::lock_guard<std::mutex> guard(worker.lock);
+		worker.tasks.push_back(std::move(task));
+		m_queued++;
+	}
+
+	// Taking the lock ensures a worker about to wait sees the new task.
+	{
+		std::lock_guard<std::mutex> guard(m_wakeLock);
+	}
+	m_wake.notify_one();
+}
+
+void ParallelSolver::FinishTask()
+{
+	if (--m_pending == 0) {
+		std::lock_guard<std::mutex> guard(m_wakeLock);
+		m_done.notify_all();
+	}
+}
+
+void ParallelSolver::Abort(SSolveStatus status)
+{
+	std::lock_guard<std::mutex> guard(m_resultLock);
+	if (!m_isSolved && !m_isAborted) {
+		m_isAborted = true;
+		m_abortStatus = status;
+	}
+	m_cancel = true;
+}
+
+bool ParallelSolver::Search(Worker& worker, SBoard& board, int depth, bool& is_shared)
+{
+	if (m_cancel)
+		return false;
+
+	SSolveStatus status;
+	if (m_budget.IsSpent(++m_nodes, status)) {
+		Abort(status);
+		return false;
+	}
+
+	uint64_t given_hash = board.GetHash();
+	if (m_table && m_table->IsDead(given_hash))
+		return false;
+
+	if (worker.solver.Eliminate(board) == SEliminationResult::Contradiction) {
+		if (m_table)
+			m_table->AddDead(given_hash);
+		return false;
+	}
+
+	uint64_t hash = board.GetHash();
+	if (m_table && (hash != given_hash) && m_table->IsDead(hash)) {
+		m_table->AddDead(given_hash);
+		return false;
+	}
+
+	if (board.IsBoardSolved()) {
+		std::lock_guard<std::mutex> guard(m_resultLock);
+		if (!m_isSolved) {
+			m_isSolved = true;
+			m_result = board;
+		}
+		m_cancel = true;
+		return true;
+	}
+
+	worker.steps++;
+
+	// Same branching as SudokuSolver::SolveBoardByRecursion(), the first free cell.
+	int index = 0;
+	while ((index < BOARD_SIZE * BOARD_SIZE) && board.GetCellDirect(index).IsSolved())
+		index++;
+	if (index == BOARD_SIZE * BOARD_SIZE)
+		return false;
+
+	SPos pos = board.GetCellDirect(index).position;
+	SValueEnum values[BOARD_SIZE];
+	int count = 0;
+	for (auto& v : { 1,2,3,4,5,6,7,8,9 }) {
+		SValueEnum testValue = static_cast<SValueEnum>(v);
+		if (board.IsValueValidAt(pos, testValue))
+			values[count++] = testValue;
+	}
+
+	// Set once this board has branches, here or further down, that other
+	// workers search. A branch handed over may still hold a solution.
+	bool is_handed_over = false;
+	for (int i = 0; i < count; i++) {
+
+		// Top of the tree: every branch becomes a task.
+		// Further down: the rest of the branches are handed over to idle workers.
+		bool is_split = (depth < m_splitDepth);
+		if (is_split || ((m_idle > 0) && (i + 1 < count))) {
+			for (int k = is_split ? i : i + 1; k < count; k++) {
+				Task task{ board, depth + 1 };
+				task.board.SetCell(pos, SCell{ values[k], SStateEnum::SState_New });
+				PushTask(worker, std::move(task));
+			}
+			is_handed_over = true;
+			if (is_split)
+				break;
+			count = i + 1;
+		}
+
+		SBoard child(board);
+		child.SetCell(pos, SCell{ values[i], SStateEnum::SState_New });
+		if (Search(worker, child, depth + 1, is_handed_over))
+			return true;
+
+		if (m_cancel)
+			return false;
+	}
+
+	if (is_handed_over) {
+		is_shared = true;
+	}
+	else if (m_table) {
+		m_table->AddDead(given_hash);
+		m_table->AddDead(hash);
+	}
+	return false;
+}
@@ -0,0 +1,144 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SudokuSolver.h"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * @class ParallelSolver
+ * @brief Solves a single board using all cores
+ *
+ * The top levels of the search tree are split into tasks, which are spread
+ * across a pool of worker threads. Each worker has its own task deque: it takes
+ * work from the back of its own deque, and once that is empty steals from the
+ * front of the others. Whenever a worker is idle, busy workers hand over the
+ * untried values of the cell they are working on, so a single large subtree
+ * is shared out rather than left to one thread.
+ *
+ * As soon as one worker has a solution, all the others are cancelled. The same
+ * happens once the budget set by `SetLimits()` is spent, with the nodes of all
+ * workers counted together.
+ *
+ * With a transposition table, boards found to have no solution are shared
+ * between the workers. A board is only added once all of its branches have
+ * been searched by the worker itself. Once any branch below it has been handed
+ * over, neither it nor any board above it is added.
+ *
+ * The threads are kept between calls, so the pool should be reused for
+ * repeated solves. `Solve()` must not be called from more than one thread at once.
+ */
+class ParallelSolver
+{
+public:
+
+    /**
+     * @param thread_count Number of worker threads, 0 = one per core
+     */
+    explicit ParallelSolver(int thread_count = 0);
+    ~ParallelSolver();
+
+    ParallelSolver(const ParallelSolver&) = delete;
+    ParallelSolver& operator=(const ParallelSolver&) = delete;
+
+    /**
+     * @brief Solves a Sudoku board, by elimination first and then by parallel search
+     * @param board The Sudoku board to solve. Receives the result of the elimination.
+     * @param board_ptr Receives the solved board (optional)
+     * @param steps The number of steps taken to solve the board, over all workers
+     * @return True if the board is solved, false otherwise
+     */
+    bool Solve(SBoard& board, SBoard* board_ptr, int& steps);
+
+    /**
+     * @brief As above, but reports why a board was not solved
+     */
+    SSolveStatus SolveWithStatus(SBoard& board, SBoard* board_ptr, int& steps);
+
+    /**
+     * @brief Sets the budgets applied to each `Solve()`. The default is no limits.
+     */
+    void SetLimits(const SSolveLimits& limits) { m_limits = limits; }
+
+    /**
+     * @brief Sets the table of boards known to have no solution, or nullptr to disable. It is not owned.
+     */
+    void SetTranspositionTable(TranspositionTable* table) { m_table = table; }
+
+    /**
+     * @brief Number of search nodes visited by the last solve, over all workers
+     */
+    uint64_t GetNodeCount() const { return m_nodes; }
+
+    /**
+     * @brief Sets how many levels of the search tree are split into tasks up front
+     */
+    void SetSplitDepth(int depth) { m_splitDepth = depth; }
+
+    int GetThreadCount() const { return static_cast<int>(m_workers.size()); }
+
+protected:
+
+    struct Task {
+        SBoard board;
+        int depth;
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::mutex lock;            // guards tasks
+        std::deque<Task> tasks;
+        SudokuSolver solver;
+        int steps = 0;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    int m_splitDepth = 2;
+    SSolveLimits m_limits;
+    SSolveBudget m_budget;
+    TranspositionTable* m_table = nullptr;
+
+    std::atomic<bool> m_exit{ false };
+    std::atomic<bool> m_cancel{ false };
+    std::atomic<int> m_queued{ 0 };     // tasks waiting in any deque
+    std::atomic<int> m_pending{ 0 };    // tasks queued or running
+    std::atomic<int> m_idle{ 0 };       // workers waiting for a task
+    std::atomic<uint64_t> m_nodes{ 0 };
+
+    std::mutex m_wakeLock;
+    std::condition_variable m_wake;     // work queued, or exiting
+    std::condition_variable m_done;     // no tasks pending
+
+    std::mutex m_resultLock;
+    bool m_isSolved = false;
+    bool m_isAborted = false;
+    SSolveStatus m_abortStatus = SSolveStatus::Unsolved;
+    SBoard m_result;
+
+    void RunWorker(size_t index);
+    bool TakeTask(size_t index, Task& task);
+    void PushTask(Worker& worker, Task&& task);
+    void FinishTask();
+
+    /**
+     * @brief Cancels all workers, once the budget is spent
+     */
+    void Abort(SSolveStatus status);
+
+    /**
+     * @brief Depth first search, sharing out branches while other workers are idle
+     * @param is_shared Set if any branch of the board, at any depth, was handed
+     *                  to another worker, so the board was not fully searched here
+     * @return True if a solution was found
+     */
+    bool Search(Worker& worker, SBoard& board, int depth, bool& is_shared);
+};
@@ -0,0 +1,135 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "PuzzleParser.h"
+#include "SBoardTables.h"
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PARSER_USE_SSE2
+#endif
+
+namespace {
+
+	void ClearPuzzle(SParsedPuzzle& puzzle)
+	{
+		std::memset(puzzle.givens, 0, sizeof(puzzle.givens));
+		std::memset(puzzle.rows, 0, sizeof(puzzle.rows));
+		std::memset(puzzle.cols, 0, sizeof(puzzle.cols));
+		std::memset(puzzle.blocks, 0, sizeof(puzzle.blocks));
+	}
+
+	/*
+	* Maps a single character. Returns false if it is not a layout character.
+	*/
+	bool ParseCell(char c, SParsedPuzzle& puzzle, int index)
+	{
+		unsigned int digit = static_cast<unsigned char>(c) - static_cast<unsigned int>('0');
+		if (digit <= 9) {
+			puzzle.values[index] = static_cast<uint8_t>(digit);
+			if (digit != 0)
+				puzzle.givens[index >> 6] |= (uint64_t(1) << (index & 63));
+			return true;
+		}
+
+		puzzle.values[index] = 0;
+		return (c == '.') || (c == ' ');
+	}
+}
+
+void SParsedPuzzle::ToBoard(SBoard& board) const
+{
+	for (int i = 0; i < SBoardTables::CellCount; i++) {
+		auto& cell = board.GetCellDirect(i);
+		cell.value = static_cast<SValueEnum>(values[i]);
+		cell.state = (values[i] != 0) ? SStateEnum::SState_Fixed : SStateEnum::SState_Free;
+	}
+	board.UpdateHash();
+}
+
+bool PuzzleParser::AddGivens(SParsedPuzzle& puzzle, int first, int last)
+{
+	for (int i = first; i < last; i++) {
+		int value = puzzle.values[i];
+		if (value == 0)
+			continue;
+
+		uint16_t bit = static_cast<uint16_t>(1 << (value - 1));
+		uint16_t& row = puzzle.rows[g_boardTables.row[i]];
+		uint16_t& col = puzzle.cols[g_boardTables.col[i]];
+		uint16_t& block = puzzle.blocks[g_boardTables.block[i]];
+		if ((row | col | block) & bit)
+			return false;
+
+		row |= bit;
+		col |= bit;
+		block |= bit;
+	}
+	return true;
+}
+
+SParseResult PuzzleParser::ParseScalar(std::string_view line, SParsedPuzzle& puzzle)
+{
+	if (line.size() != SBoardTables::CellCount)
+		return SParseResult::BadLength;
+
+	ClearPuzzle(puzzle);
+	bool has_duplicate = false;
+	for (int i = 0; i < SBoardTables::CellCount; i++) {
+		if (!ParseCell(line[i], puzzle, i))
+			return SParseResult::BadCharacter;
+		has_duplicate = has_duplicate || !AddGivens(puzzle, i, i + 1);
+	}
+	return has_duplicate ? SParseResult::DuplicateGiven : SParseResult::Ok;
+}
+
+SParseResult PuzzleParser::Parse(std::string_view line, SParsedPuzzle& puzzle)
+{
+#ifdef PARSER_USE_SSE2
+	if (line.size() != SBoardTables::CellCount)
+		return SParseResult::BadLength;
+
+	ClearPuzzle(puzzle);
+
+	const __m128i zero_char = _mm_set1_epi8('0');
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i dot_char = _mm_set1_epi8('.');
+	const __m128i space_char = _mm_set1_epi8(' ');
+
+	// 5 blocks of 16 characters, then the last one on its own. The blocks never
+	// straddle a 64 bit word of the givens mask.
+	// NB: Bad characters are reported ahead of duplicates, as ParseScalar().
+	bool has_duplicate = false;
+	int i = 0;
+	for (; i + 16 <= SBoardTables::CellCount; i += 16) {
+		__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line.data() + i));
+
+		// '0' - '9' become 0 - 9. Anything else becomes > 9 (as unsigned).
+		__m128i digits = _mm_sub_epi8(chars, zero_char);
+		__m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+		__m128i is_empty = _mm_or_si128(_mm_cmpeq_epi8(chars, dot_char), _mm_cmpeq_epi8(chars, space_char));
+		if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_empty)) != 0xFFFF)
+			return SParseResult::BadCharacter;
+
+		__m128i values = _mm_and_si128(digits, is_digit);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(puzzle.values + i), values);
+
+		uint64_t given = ~static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(values, _mm_setzero_si128()))) & 0xFFFF;
+		puzzle.givens[i >> 6] |= (given << (i & 63));
+
+		has_duplicate = has_duplicate || !AddGivens(puzzle, i, i + 16);
+	}
+
+	for (; i < SBoardTables::CellCount; i++) {
+		if (!ParseCell(line[i], puzzle, i))
+			return SParseResult::BadCharacter;
+		has_duplicate = has_duplicate || !AddGivens(puzzle, i, i + 1);
+	}
+	return has_duplicate ? SParseResult::DuplicateGiven : SParseResult::Ok;
+#else
+	return ParseScalar(line, puzzle);
+#endif
+}
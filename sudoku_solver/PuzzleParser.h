@@ -0,0 +1,76 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoard.h"
+#include <string_view>
+#include <cstdint>
+
+/**
+ * @brief Outcome of parsing a puzzle line
+ */
+enum class SParseResult {
+    Ok,
+    BadLength,          // not 81 characters
+    BadCharacter,       // not '1' - '9', or an empty cell marker
+    DuplicateGiven      // a value appears twice in a row, column or block
+};
+
+/**
+ * @brief A parsed puzzle line
+ *
+ * Digit masks use bit (value - 1), as `SolverSession`.
+ */
+struct SParsedPuzzle
+{
+    uint8_t values[BOARD_SIZE * BOARD_SIZE];    // 0 for empty cells
+    uint64_t givens[2];                         // bit (index % 64) of word (index / 64) set for each given
+    uint16_t rows[BOARD_SIZE];                  // values given in each row
+    uint16_t cols[BOARD_SIZE];                  // values given in each column
+    uint16_t blocks[BOARD_SIZE];                // values given in each block
+
+    bool IsGiven(int index) const { return (givens[index >> 6] >> (index & 63)) & 1; }
+
+    /**
+     * @brief Loads the values into the board. Givens are fixed, other cells free.
+     */
+    void ToBoard(SBoard& board) const;
+};
+
+/**
+ * @class PuzzleParser
+ * @brief Parser and validator for 81 character puzzle lines
+ *
+ * Accepts the same characters as `SudokuSolver::LoadBoardFromStringLayout()`:
+ * '1' - '9' for givens, and '0', '.' or ' ' for empty cells. Characters are
+ * mapped and checked 16 at a time with SSE2 where available, and duplicate
+ * givens are found while the unit masks are built, so a line is only walked
+ * once.
+ */
+class PuzzleParser
+{
+public:
+
+    /**
+     * @brief Parses and validates a puzzle line
+     * @param line The puzzle, without any line terminator
+     * @param puzzle Receives the parsed puzzle. Only complete if Ok is returned.
+     */
+    static SParseResult Parse(std::string_view line, SParsedPuzzle& puzzle);
+
+    /**
+     * @brief Portable version of `Parse()`, also used where SSE2 is not available
+     */
+    static SParseResult ParseScalar(std::string_view line, SParsedPuzzle& puzzle);
+
+protected:
+
+    /**
+     * @brief Adds the values of cells [first, last) to the unit masks
+     * @return False if a value is already in one of its units
+     */
+    static bool AddGivens(SParsedPuzzle& puzzle, int first, int last);
+};
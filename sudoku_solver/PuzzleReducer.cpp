@@ -0,0 +1,201 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "PuzzleReducer.h"
+#include <algorithm>
+#include <cstring>
+
+PuzzleReducer::PuzzleReducer(int thread_count /*= 1*/)
+{
+	if (thread_count <= 0)
+		thread_count = static_cast<int>(std::thread::hardware_concurrency());
+	if (thread_count <= 0)
+		thread_count = 1;
+
+	for (int slot = 1; slot < thread_count; slot++) {
+		m_workers.emplace_back(&PuzzleReducer::RunWorker, this, slot);
+	}
+}
+
+PuzzleReducer::~PuzzleReducer()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_exit = true;
+	}
+	m_start.notify_all();
+
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+}
+
+/*
+* The puzzle is unique, so the clue is only needed if some other value in its
+* cell also leads to a solution.
+*/
+bool PuzzleReducer::IsRemovable(const SUnitMasks& state, int cell)
+{
+	SUnitMasks test = state;
+	uint16_t bit = static_cast<uint16_t>(1 << (test.values[cell] - 1));
+	test.Remove(cell);
+
+	for (uint16_t others = test.GetCandidates(cell) & ~bit; others; others &= others - 1) {
+		test.Place(cell, others & (0 - others));
+		if (test.CountCompletions(1) != 0)
+			return false;
+		test.Remove(cell);
+	}
+	return true;
+}
+
+int PuzzleReducer::CountSolutions(const Grid& puzzle, int limit)
+{
+	// Clashing clues would otherwise never be noticed by the search.
+	SUnitMasks state;
+	if (!state.Load(puzzle))
+		return 0;
+	return state.CountCompletions(limit);
+}
+
+bool PuzzleReducer::IsMinimal(const Grid& puzzle)
+{
+	if (CountSolutions(puzzle, 2) != 1)
+		return false;
+
+	SUnitMasks state;
+	state.Load(puzzle);
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		if ((puzzle[cell] != 0) && IsRemovable(state, cell))
+			return false;
+	}
+	return true;
+}
+
+bool PuzzleReducer::Reduce(const Grid& puzzle, Grid& minimal, const std::vector<int>* order /*= nullptr*/)
+{
+	m_stats = SReduceStats{};
+	if (CountSolutions(puzzle, 2) != 1)
+		return false;
+
+	std::vector<int> pending;
+	pending.reserve(SBoardTables::CellCount);
+	if (order) {
+		for (int cell : *order) {
+			if ((cell >= 0) && (cell < SBoardTables::CellCount) && (puzzle[cell] != 0))
+				pending.push_back(cell);
+		}
+	}
+	else {
+		for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+			if (puzzle[cell] != 0)
+				pending.push_back(cell);
+		}
+	}
+
+	m_batchState.Load(puzzle);
+	size_t batch_size = m_workers.size() + 1;
+	size_t next = 0;
+
+	while (next < pending.size()) {
+		size_t count = std::min(batch_size, pending.size() - next);
+		m_batchCells.assign(pending.begin() + next, pending.begin() + next + count);
+		m_batchRemovable.assign(count, 0);
+		TestBatch();
+		m_stats.checks += count;
+
+		// Clues found to be needed are final. The first removable clue is
+		// removed, and any later removable ones are tested again.
+		size_t retest = next + count;
+		for (size_t i = 0; i < count; i++) {
+			if (!m_batchRemovable[i])
+				continue;
+
+			m_batchState.Remove(m_batchCells[i]);
+
+			retest = next + i + 1;
+			break;
+		}
+
+		for (size_t i = retest - next; i < count; i++) {
+			if (m_batchRemovable[i]) {
+				pending.push_back(m_batchCells[i]);
+				m_stats.retests++;
+			}
+		}
+		next += count;
+	}
+
+	std::memcpy(minimal, m_batchState.values, sizeof(m_batchState.values));
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		if (minimal[cell] != 0)
+			m_stats.clues++;
+	}
+	return true;
+}
+
+bool PuzzleReducer::Reduce(SBoard& board, const std::vector<int>* order /*= nullptr*/)
+{
+	Grid puzzle;
+	Grid minimal;
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		puzzle[cell] = static_cast<uint8_t>(board.GetCellDirect(cell).value);
+	}
+
+	if (!Reduce(puzzle, minimal, order))
+		return false;
+
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		auto& c = board.GetCellDirect(cell);
+		c.value = static_cast<SValueEnum>(minimal[cell]);
+		c.state = (minimal[cell] != 0) ? SStateEnum::SState_Fixed : SStateEnum::SState_Free;
+	}
+	board.UpdateHash();
+	return true;
+}
+
+void PuzzleReducer::TestBatch()
+{
+	size_t count = m_batchCells.size();
+	if (count > 1) {
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_running = static_cast<int>(m_workers.size());
+			m_generation++;
+		}
+		m_start.notify_all();
+	}
+
+	m_batchRemovable[0] = IsRemovable(m_batchState, m_batchCells[0]);
+
+	if (count > 1) {
+		std::unique_lock<std::mutex> guard(m_lock);
+		m_finished.wait(guard, [this] { return m_running == 0; });
+	}
+}
+
+void PuzzleReducer::RunWorker(int slot)
+{
+	uint64_t seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(m_lock);
+			m_start.wait(guard, [this, seen] { return m_exit || (m_generation != seen); });
+			if (m_exit)
+				return;
+			seen = m_generation;
+		}
+
+		// The batch may be smaller than the number of threads.
+		if (static_cast<size_t>(slot) < m_batchCells.size())
+			m_batchRemovable[slot] = IsRemovable(m_batchState, m_batchCells[slot]);
+
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			if (--m_running == 0)
+				m_finished.notify_one();
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoardTables.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+/**
+ * @brief Counts kept by `PuzzleReducer`
+ */
+struct SReduceStats
+{
+    int clues = 0;              // clues left in the last puzzle reduced
+    uint64_t checks = 0;        // clue removals tested
+    uint64_t retests = 0;       // removals tested again, after another clue was removed first
+};
+
+/**
+ * @class PuzzleReducer
+ * @brief Removes clues from a puzzle until every clue left is needed
+ *
+ * A clue can be removed if the puzzle keeps a unique solution without it.
+ * Given that the puzzle has a unique solution, this is the case if no
+ * solution exists with any other value in that cell, which is a search that
+ * stops at the first solution rather than a full count.
+ *
+ * A clue found to be needed stays needed as more clues are removed (removing
+ * clues can only add solutions). So several clues are tested at once, one per
+ * thread, against the same puzzle. Those found needed are final. Of the ones
+ * found removable, the first in order is removed and the rest are tested
+ * again against the smaller puzzle.
+ *
+ * The unit masks of the puzzle are kept up to date as clues are removed, and
+ * each test starts from a copy of them.
+ */
+class PuzzleReducer
+{
+public:
+
+    using Grid = uint8_t[SBoardTables::CellCount];   // values 0 - 9 in row order, 0 for empty
+
+    /**
+     * @param thread_count Number of clues tested at once, 0 = one per core
+     */
+    explicit PuzzleReducer(int thread_count = 1);
+    ~PuzzleReducer();
+
+    PuzzleReducer(const PuzzleReducer&) = delete;
+    PuzzleReducer& operator=(const PuzzleReducer&) = delete;
+
+    /**
+     * @brief Reduces a puzzle (or a solved grid) to a minimal puzzle
+     * @param puzzle The puzzle to reduce, which must have a unique solution
+     * @param minimal Receives the minimal puzzle
+     * @param order The order in which to try removing the cells (optional,
+     *              default index order). Cells not listed are kept.
+     * @return False if the puzzle does not have a unique solution
+     */
+    bool Reduce(const Grid& puzzle, Grid& minimal, const std::vector<int>* order = nullptr);
+
+    /**
+     * @brief As above, reducing the board in place. The clues left are fixed.
+     */
+    bool Reduce(SBoard& board, const std::vector<int>* order = nullptr);
+
+    /**
+     * @brief Counts the solutions of a puzzle, stopping at the limit
+     */
+    static int CountSolutions(const Grid& puzzle, int limit);
+
+    /**
+     * @brief Tests whether the puzzle is unique, and no clue can be removed
+     */
+    static bool IsMinimal(const Grid& puzzle);
+
+    const SReduceStats& GetStats() const { return m_stats; }
+
+    int GetThreadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+protected:
+
+    /**
+     * @brief Tests whether the clue of the cell can be removed from the state
+     */
+    static bool IsRemovable(const SUnitMasks& state, int cell);
+
+    SReduceStats m_stats;
+
+    // Speculative tests of one batch. Slot 0 is tested by the calling thread.
+    SUnitMasks m_batchState;
+    std::vector<int> m_batchCells;
+    std::vector<char> m_batchRemovable;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_lock;
+    std::condition_variable m_start;
+    std::condition_variable m_finished;
+    uint64_t m_generation = 0;
+    int m_running = 0;
+    bool m_exit = false;
+
+    void RunWorker(int slot);
+    void TestBatch();
+};
@@ -1,4 +1,5 @@
 #include "SBoard.h"
+#include "SBoardTables.h"
 #include <algorithm>
 #include <set>
 #include <cassert>
@@ -17,6 +18,7 @@ void SBoard::ClearBoard()
 {
 	m_boarddata.clear();
 	m_boarddata.resize(BOARD_SIZE * BOARD_SIZE);
+	m_hash = 0;
 
 	for (auto j = 0; j < BOARD_SIZE; j++) {
 		for (auto i = 0; i < BOARD_SIZE; i++) {
@@ -41,8 +43,9 @@ int SBoard::GetCellIndexFrom(int col, int row) const
 std::vector<SCell> SBoard::GetRow(int r) const
 {
 	std::vector<SCell> v;
-	for (auto c = 0; c < BOARD_SIZE; c++) {
-		v.push_back(GetCell(c, r));
+	v.reserve(BOARD_SIZE);
+	for (auto cell : g_boardTables.cells[r]) {
+		v.push_back(m_boarddata[cell]);
 	}
 	return v;
 }
@@ -50,8 +53,9 @@ std::vector<SCell> SBoard::GetRow(int r) const
 std::vector<SCell> SBoard::GetCol(int c) const
 {
 	std::vector<SCell> v;
-	for (auto r = 0; r < BOARD_SIZE; r++) {
-		v.push_back(GetCell(c, r));
+	v.reserve(BOARD_SIZE);
+	for (auto cell : g_boardTables.cells[SBoardTables::FirstColumnUnit + c]) {
+		v.push_back(m_boarddata[cell]);
 	}
 	return v;
 }
@@ -70,20 +74,25 @@ void SBoard::SetCell(int col, int row, SCell cell)
 		return;
 
 	cell.position = SPos{ col,row };
-	m_boarddata[cell.position.GetBoardIndex()] = cell;
+	int index = cell.position.GetBoardIndex();
+	m_hash ^= g_boardTables.zobrist[index][static_cast<int>(m_boarddata[index].value)] ^ g_boardTables.zobrist[index][static_cast<int>(cell.value)];
+	m_boarddata[index] = cell;
+}
+
+void SBoard::UpdateHash()
+{
+	m_hash = 0;
+	for (int index = 0; index < BOARD_SIZE * BOARD_SIZE; index++) {
+		m_hash ^= g_boardTables.zobrist[index][static_cast<int>(m_boarddata[index].value)];
+	}
 }
 
 std::vector<SCell> SBoard::GetBlock(int index) const
 {
 	std::vector<SCell> vec;
-
-	int start_column = (index % BLOCK_SIZE) * BLOCK_SIZE;
-	int start_row = (index / BLOCK_SIZE) * BLOCK_SIZE;
-
-	for (auto i = start_column; i < (start_column + BLOCK_SIZE); i++) {
-		for (auto j = start_row; j < (start_row + BLOCK_SIZE); j++) {
-			vec.push_back(GetCell(i, j ));
-		}
+	vec.reserve(BOARD_SIZE);
+	for (auto cell : g_boardTables.cells[SBoardTables::FirstBlockUnit + index]) {
+		vec.push_back(m_boarddata[cell]);
 	}
 
 	return vec;
@@ -145,47 +154,21 @@ bool SBoard::IsValid(std::vector<SCell>& vec) const
 */
 bool SBoard::IsValueValidAt(int col, int row, SValueEnum value) const
 {
-	bool isvalid = true;
-
-	// Test Row
-	// Iterate through the row cells, and compare against our test value.
-	// If it is the same (and not empty), then the test fails.
-	int rowindex = BOARD_SIZE * row;
-	for (int r = rowindex; r < (rowindex + BOARD_SIZE); r++) {
-		auto row_value = m_boarddata[r].value;
-		if ((row_value != SValueEnum::SValue_Empty) && (row_value == value)) {
-			isvalid = false;
-		}
-	}
+	if (value == SValueEnum::SValue_Empty)
+		return true;
 
-	// Test Column
-	// Here we are moving down the grid.
-	int colindex = SPos(col, 0).GetBoardIndex();
-	for (int c = 0; c < BOARD_SIZE; c++) {
-		auto col_value = m_boarddata[colindex].value;
-		if ((col_value != SValueEnum::SValue_Empty) && (col_value == value)) {
-			isvalid = false;
-		}
-		colindex += BOARD_SIZE;
-	}
+	// The value must not already be in the cell's row, column or block, which
+	// are the cell itself and its 20 peers.
+	int cell = GetCellIndexFrom(col, row);
+	if (m_boarddata[cell].value == value)
+		return false;
 
-	// Test Block
-	int bidx = GetBlockIndexFrom(col, row);
-	int start_column = (bidx % BLOCK_SIZE) * BLOCK_SIZE;
-	int start_row = (bidx / BLOCK_SIZE) * BLOCK_SIZE;
-	int bindex = (start_row * BOARD_SIZE) + start_column;
-
-	for (int r = 0; r < BLOCK_SIZE; r++) {
-		for (int c = 0; c < BLOCK_SIZE; c++) {
-			int block_index = (r * BOARD_SIZE) + c + bindex;
-			auto block_value = m_boarddata[block_index].value;
-			if ((block_value != SValueEnum::SValue_Empty) && (block_value == value)) {
-				isvalid = false;
-			}
-		}
+	for (auto peer : g_boardTables.peers[cell]) {
+		if (m_boarddata[peer].value == value)
+			return false;
 	}
 	
-	return isvalid;
+	return true;
 }
 
 /*
@@ -193,11 +176,7 @@ bool SBoard::IsValueValidAt(int col, int row, SValueEnum value) const
 */
 int SBoard::GetBlockIndexFrom(int col, int row) const
 {
-	int cell_index = GetCellIndexFrom(col, row);
-	int block_col = (cell_index / BLOCK_SIZE) % BLOCK_SIZE;
-	int block_row = (cell_index / BOARD_SIZE) / BLOCK_SIZE;
-	int block_index = (block_row * BLOCK_SIZE) + block_col;
-	return block_index;
+	return g_boardTables.block[GetCellIndexFrom(col, row)];
 }
 
 std::vector<SPos> SBoard::GetFreeCells()
@@ -223,29 +202,42 @@ std::vector<SPos> SBoard::GetSolvedCells()
 	return vec;
 }
 
-// TODO: Optimise and remove GetCol()/GetRow() methods.
+/*
+* Every row, column and block must hold each of the values 1 - 9.
+*/
 bool SBoard::IsBoardSolved() const
 {
-	bool IsRowSolved   = true;
-	bool IsColSolved   = true;
-	bool IsBlockSolved = true;
-
-	for (auto col = 0; col < BOARD_SIZE; col++) {
-		auto col_vec = GetCol(col);
-		IsColSolved &= IsSolved(col_vec);
-	}
+	for (const auto& unit : g_boardTables.cells) {
+		unsigned int seen = 0;
+		for (auto cell : unit) {
+			seen |= (1u << static_cast<int>(m_boarddata[cell].value));
+		}
 
-	for (auto row = 0; row < BOARD_SIZE; row++) {
-		auto row_vec = GetRow(row);
-		IsRowSolved &= IsSolved(row_vec);
+		// bit 0 is set by an empty cell
+		if (seen != 0x3FE)
+			return false;
 	}
+	return true;
+}
 
-	for (auto b : { 0,1,2,3,4,5,6,7,8 }) {
-		auto block_vec = GetBlock(b);
-		IsBlockSolved &= IsSolved(block_vec);
+/*
+* Checks for duplicates only, so this can be called on an incomplete board.
+*/
+bool SBoard::IsBoardValid() const
+{
+	for (const auto& unit : g_boardTables.cells) {
+		unsigned int seen = 0;
+		for (auto cell : unit) {
+			auto value = static_cast<int>(m_boarddata[cell].value);
+			if (value == 0)
+				continue;
+
+			if (seen & (1u << value))
+				return false;
+			seen |= (1u << value);
+		}
 	}
-
-	return IsRowSolved && IsColSolved && IsBlockSolved;
+	return true;
 }
 
 
@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <set>
+#include <cstdint>
 
 // How many cells per side on our board
 #define BOARD_SIZE 9
@@ -174,6 +175,11 @@ public:
 	SCell & GetCellDirect(int index) {
 		return m_boarddata[index];
 	}
+
+	/*overload*/
+	const SCell & GetCellDirect(int index) const {
+		return m_boarddata[index];
+	}
 		
 	/*
 	* Sets the cell value or state of the given board cell.
@@ -190,6 +196,18 @@ public:
 	*/
 	void ClearBoard();
 
+	/*
+	* Zobrist hash of the cell values, kept up to date by `SetCell()`.
+	* Equal boards have equal hashes. The cell states are not included.
+	*/
+	uint64_t GetHash() const { return m_hash; }
+
+	/*
+	* Recalculates the hash. Must be called after changing cell values
+	* through `GetCellDirect()`.
+	*/
+	void UpdateHash();
+
 	/*
 	* Tests if given array of cells has all the numbers present
 	*/
@@ -216,6 +234,12 @@ public:
 	*/
 	bool IsBoardSolved() const;
 
+	/*
+	* Tests every row, column and block of the board for duplicate values.
+	* Empty cells are ignored.
+	*/
+	bool IsBoardValid() const;
+
 	/*!	\brief Returns the visual character to represent given cell state
 	* 
 	*	\return A valid representation of a given board cell.
@@ -233,6 +257,7 @@ public:
 
 protected:
 	std::vector<SCell> m_boarddata;
+	uint64_t m_hash = 0;
 
 	/*
 	* Returns the index within our internal array, given the cell coordinates.
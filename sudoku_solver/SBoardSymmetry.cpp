@@ -0,0 +1,264 @@
+/* ======================================
+* Author : Richard Chin
+* Date   : July 2020
+* =======================================*/
+#include "SBoardSymmetry.h"
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+	using Grid = std::array<uint8_t, BOARD_SIZE * BOARD_SIZE>;
+	using Order = std::array<uint8_t, BOARD_SIZE>;
+
+	/*
+	* A column ordering together with the digit relabelling it has built up so
+	* far. Digits are labelled in order of first appearance, as this is what
+	* gives the smallest layout for any given arrangement of the cells.
+	*/
+	struct ColumnCandidate {
+		Order cols;
+		std::array<uint8_t, BOARD_SIZE + 1> digits;		// source => canonical, 0 = not yet seen
+		uint8_t next_digit;
+	};
+
+	/*
+	* Returns all 1296 column orders which keep each column within a stack
+	* (6 stack orders x 6 orders within each of the 3 stacks).
+	*/
+	const std::vector<Order>& GetColumnOrders()
+	{
+		static const std::vector<Order> orders = [] {
+			const uint8_t perms[6][3] = { {0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0} };
+			std::vector<Order> v;
+			v.reserve(6 * 6 * 6 * 6);
+			for (auto& stacks : perms) {
+				for (auto& p0 : perms) {
+					for (auto& p1 : perms) {
+						for (auto& p2 : perms) {
+							const uint8_t* within[3] = { p0, p1, p2 };
+							Order o;
+							for (int s = 0; s < BLOCK_SIZE; s++) {
+								for (int c = 0; c < BLOCK_SIZE; c++) {
+									o[s * BLOCK_SIZE + c] = static_cast<uint8_t>(stacks[s] * BLOCK_SIZE + within[s][c]);
+								}
+							}
+							v.push_back(o);
+						}
+					}
+				}
+			}
+			return v;
+		}();
+		return orders;
+	}
+
+	/*
+	* Branch and bound search for the smallest layout.
+	*
+	* Output rows are chosen one at a time. For each level, every permitted
+	* source row is tried against every column candidate that is still tied for
+	* the smallest result so far. Only the (row, candidate) pairs that produce
+	* the smallest output row survive to the next level, so the candidate set
+	* collapses quickly on real puzzles.
+	*/
+	class CanonicalSearch
+	{
+	public:
+		Grid source[2];		// [0] as given, [1] transposed
+		Grid current{};
+		Grid best{};
+		bool has_best = false;
+		SBoardTransform best_transform;
+
+		void Run(int transposed, int level, const std::vector<ColumnCandidate>& candidates)
+		{
+			if (level == BOARD_SIZE) {
+				if (!has_best || current < best) {
+					best = current;
+					has_best = true;
+					RecordTransform(transposed, candidates.front());
+				}
+				return;
+			}
+
+			// Rows stay within their band, bands move as a whole.
+			int first_row = 0, last_row = BOARD_SIZE;
+			if ((level % BLOCK_SIZE) != 0) {
+				first_row = (m_rows[level - 1] / BLOCK_SIZE) * BLOCK_SIZE;
+				last_row = first_row + BLOCK_SIZE;
+			}
+
+			const Grid& g = source[transposed];
+			Order min_row{};
+			bool has_min = false;
+			std::vector<std::pair<int, ColumnCandidate>> survivors;
+
+			for (int s = first_row; s < last_row; s++) {
+				if (m_used & (1 << s))
+					continue;
+				if (((level % BLOCK_SIZE) == 0) && (m_usedBands & (1 << (s / BLOCK_SIZE))))
+					continue;
+
+				const uint8_t* src = &g[s * BOARD_SIZE];
+				for (auto next : candidates) {
+					Order row;
+					int cmp = has_min ? 0 : -1;
+					for (int c = 0; c < BOARD_SIZE; c++) {
+						uint8_t v = src[next.cols[c]];
+						if (v != 0) {
+							if (next.digits[v] == 0)
+								next.digits[v] = ++next.next_digit;
+							v = next.digits[v];
+						}
+						row[c] = v;
+						if (cmp == 0) {
+							if (v < min_row[c]) cmp = -1;
+							else if (v > min_row[c]) { cmp = 1; break; }
+						}
+					}
+
+					if (cmp > 0)
+						continue;
+					if (cmp < 0) {
+						min_row = row;
+						has_min = true;
+						survivors.clear();
+					}
+					survivors.push_back({ s, next });
+				}
+			}
+
+			if (survivors.empty())
+				return;
+
+			std::copy(min_row.begin(), min_row.end(), current.begin() + level * BOARD_SIZE);
+
+			// Anything already worse than the best layout can be dropped.
+			int prefix = (level + 1) * BOARD_SIZE;
+			if (has_best && std::lexicographical_compare(best.begin(), best.begin() + prefix, current.begin(), current.begin() + prefix))
+				return;
+
+			// Survivors are grouped by source row, recurse into each group.
+			std::vector<ColumnCandidate> group;
+			for (size_t i = 0; i < survivors.size(); ) {
+				int s = survivors[i].first;
+				group.clear();
+				for (; (i < survivors.size()) && (survivors[i].first == s); i++)
+					group.push_back(survivors[i].second);
+
+				m_rows[level] = static_cast<uint8_t>(s);
+				m_used |= (1 << s);
+				if ((level % BLOCK_SIZE) == 0)
+					m_usedBands |= (1 << (s / BLOCK_SIZE));
+
+				Run(transposed, level + 1, group);
+
+				m_used &= ~(1 << s);
+				if ((level % BLOCK_SIZE) == 0)
+					m_usedBands &= ~(1 << (s / BLOCK_SIZE));
+			}
+		}
+
+	protected:
+		Order m_rows{};
+		int m_used = 0;
+		int m_usedBands = 0;
+
+		void RecordTransform(int transposed, const ColumnCandidate& candidate)
+		{
+			best_transform.transpose = (transposed != 0);
+			for (int i = 0; i < BOARD_SIZE; i++) {
+				best_transform.rows[i] = m_rows[i];
+				best_transform.cols[i] = candidate.cols[i];
+			}
+
+			// Digits missing from the board still need a label, so that the
+			// transform remains a full relabelling (needed to map solutions).
+			int next_digit = candidate.next_digit;
+			best_transform.digits[0] = 0;
+			for (int v = 1; v <= BOARD_SIZE; v++) {
+				best_transform.digits[v] = candidate.digits[v] ? candidate.digits[v] : ++next_digit;
+			}
+		}
+	};
+}
+
+std::wstring SBoardSymmetry::GetCanonicalForm(const SBoard& board, SBoardTransform& transform)
+{
+	CanonicalSearch search;
+	bool is_empty = true;
+
+	for (int row = 0; row < BOARD_SIZE; row++) {
+		for (int col = 0; col < BOARD_SIZE; col++) {
+			auto v = static_cast<uint8_t>(board.GetCell(col, row).value);
+			search.source[0][row * BOARD_SIZE + col] = v;
+			search.source[1][col * BOARD_SIZE + row] = v;
+			is_empty &= (v == 0);
+		}
+	}
+
+	// Every arrangement of a blank board ties, so skip the search.
+	if (is_empty) {
+		transform = SBoardTransform{};
+		return std::wstring(BOARD_SIZE * BOARD_SIZE, L'0');
+	}
+
+	std::vector<ColumnCandidate> candidates;
+	candidates.reserve(GetColumnOrders().size());
+	for (auto& order : GetColumnOrders()) {
+		candidates.push_back({ order, {}, 0 });
+	}
+
+	search.Run(0, 0, candidates);
+	search.Run(1, 0, candidates);
+
+	transform = search.best_transform;
+
+	std::wstring layout;
+	layout.reserve(BOARD_SIZE * BOARD_SIZE);
+	for (auto v : search.best) {
+		layout.push_back(static_cast<wchar_t>(L'0' + v));
+	}
+	return layout;
+}
+
+SBoard SBoardSymmetry::Apply(const SBoard& board, const SBoardTransform& transform)
+{
+	SBoard result;
+	for (int r = 0; r < BOARD_SIZE; r++) {
+		for (int c = 0; c < BOARD_SIZE; c++) {
+			int src_row = transform.rows[r];
+			int src_col = transform.cols[c];
+			SCell cell = transform.transpose ? board.GetCell(src_row, src_col) : board.GetCell(src_col, src_row);
+			cell.value = static_cast<SValueEnum>(transform.digits[static_cast<int>(cell.value)]);
+			result.SetCell(c, r, cell);
+		}
+	}
+	return result;
+}
+
+SBoard SBoardSymmetry::ApplyInverse(const SBoard& board, const SBoardTransform& transform)
+{
+	std::array<int, BOARD_SIZE + 1> inverse_digits{};
+	for (int v = 0; v <= BOARD_SIZE; v++) {
+		inverse_digits[transform.digits[v]] = v;
+	}
+
+	SBoard result;
+	for (int r = 0; r < BOARD_SIZE; r++) {
+		for (int c = 0; c < BOARD_SIZE; c++) {
+			SCell cell = board.GetCell(c, r);
+			cell.value = static_cast<SValueEnum>(inverse_digits[static_cast<int>(cell.value)]);
+
+			int dst_row = transform.rows[r];
+			int dst_col = transform.cols[c];
+			if (transform.transpose)
+				result.SetCell(dst_row, dst_col, cell);
+			else
+				result.SetCell(dst_col, dst_row, cell);
+		}
+	}
+	return result;
+}
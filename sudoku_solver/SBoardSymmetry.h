@@ -0,0 +1,69 @@
+/* ======================================
+* Author : Richard Chin
+* Date   : July 2020
+* =======================================*/
+#pragma once
+
+#include "SBoard.h"
+#include <array>
+#include <string>
+
+/*!	\brief Describes a validity-preserving rearrangement of a board
+*
+*	A transform is applied in the following order:
+*	  1. The source board is optionally transposed (rows become columns).
+*	  2. Output row 'r' is taken from source row `rows[r]`, and output column
+*	     'c' from source column `cols[c]`. Rows may only move within their band
+*	     (and bands as a whole), columns within their stack.
+*	  3. Every value 'v' is relabelled to `digits[v]`. Empty cells stay empty.
+*/
+struct SBoardTransform
+{
+	bool transpose = false;
+	std::array<int, BOARD_SIZE> rows = { 0,1,2,3,4,5,6,7,8 };
+	std::array<int, BOARD_SIZE> cols = { 0,1,2,3,4,5,6,7,8 };
+	std::array<int, BOARD_SIZE + 1> digits = { 0,1,2,3,4,5,6,7,8,9 };
+};
+
+/*!	\brief Symmetry operations on a sudoku board
+*
+*	Two puzzles are equivalent if one can be turned into the other through
+*	digit relabelling, row/column swaps within bands and stacks, band/stack
+*	swaps and transposition. Equivalent puzzles share a single canonical form,
+*	which makes it usable as a key for deduplication and for sharing solutions.
+*/
+class SBoardSymmetry
+{
+public:
+
+	/*!	\brief Returns the canonical form of the board
+	*
+	*	The canonical form is the lexicographically smallest 81 character layout
+	*	(same notation as `SudokuSolver::GetBoardAsStringLayout()`, with '0' for
+	*	empty cells) over all equivalent boards.
+	*
+	*	\param board The board to canonicalise.
+	*	\param transform Receives the transform that maps `board` onto its
+	*	       canonical form. Use `ApplyInverse()` to map results back.
+	*	\return The 81 character canonical layout.
+	*/
+	static std::wstring GetCanonicalForm(const SBoard& board, SBoardTransform& transform);
+
+	/*overload*/
+	static std::wstring GetCanonicalForm(const SBoard& board) {
+		SBoardTransform transform;
+		return GetCanonicalForm(board, transform);
+	}
+
+	/*!	\brief Returns a copy of the board with the transform applied
+	*	Cell states are carried across with their values.
+	*/
+	static SBoard Apply(const SBoard& board, const SBoardTransform& transform);
+
+	/*!	\brief Reverses `Apply()`
+	*
+	*	E.g. a solution of the canonical puzzle can be mapped back onto the
+	*	original puzzle with the transform returned from `GetCanonicalForm()`.
+	*/
+	static SBoard ApplyInverse(const SBoard& board, const SBoardTransform& transform);
+};
@@ -0,0 +1,275 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoard.h"
+#include <cstdint>
+
+/**
+ * @brief Board geometry lookup tables, built at compile time
+ *
+ * Cells are indexed 0 - 80 in row order, as `SPos::GetBoardIndex()`. Units are
+ * the rows (0 - 8), then the columns (9 - 17), then the blocks (18 - 26), and
+ * the cells of each unit are listed in row order. Blocks are numbered as for
+ * `SBoard::GetBlock()`.
+ *
+ * Use `g_boardTables` rather than dividing cell indices in inner loops.
+ *
+ * The Zobrist keys give each value of each cell a random 64-bit key. The hash
+ * of a board is the XOR of the keys of its cells. Empty cells have a key of 0.
+ */
+struct SBoardTables
+{
+    static constexpr int CellCount = BOARD_SIZE * BOARD_SIZE;
+    static constexpr int UnitCount = 3 * BOARD_SIZE;
+    static constexpr int PeerCount = 2 * (BOARD_SIZE - 1) + (BOARD_SIZE - 2 * BLOCK_SIZE + 1);
+    static constexpr int FirstColumnUnit = BOARD_SIZE;
+    static constexpr int FirstBlockUnit = 2 * BOARD_SIZE;
+
+    uint8_t row[CellCount];
+    uint8_t col[CellCount];
+    uint8_t block[CellCount];
+    uint8_t units[CellCount][3];                // row, column and block unit of each cell
+    uint8_t cells[UnitCount][BOARD_SIZE];       // cells of each unit
+    uint8_t peers[CellCount][PeerCount];        // cells sharing a unit, in index order
+    uint64_t zobrist[CellCount][BOARD_SIZE + 1];  // key of each value of each cell
+};
+
+constexpr SBoardTables MakeBoardTables()
+{
+    SBoardTables t{};
+
+    for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+        int row = cell / BOARD_SIZE;
+        int col = cell % BOARD_SIZE;
+        int block = (row / BLOCK_SIZE) * BLOCK_SIZE + (col / BLOCK_SIZE);
+        int block_pos = (row % BLOCK_SIZE) * BLOCK_SIZE + (col % BLOCK_SIZE);
+
+        t.row[cell] = static_cast<uint8_t>(row);
+        t.col[cell] = static_cast<uint8_t>(col);
+        t.block[cell] = static_cast<uint8_t>(block);
+        t.units[cell][0] = static_cast<uint8_t>(row);
+        t.units[cell][1] = static_cast<uint8_t>(SBoardTables::FirstColumnUnit + col);
+        t.units[cell][2] = static_cast<uint8_t>(SBoardTables::FirstBlockUnit + block);
+        t.cells[row][col] = static_cast<uint8_t>(cell);
+        t.cells[SBoardTables::FirstColumnUnit + col][row] = static_cast<uint8_t>(cell);
+        t.cells[SBoardTables::FirstBlockUnit + block][block_pos] = static_cast<uint8_t>(cell);
+    }
+
+    for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+        int n = 0;
+        for (int other = 0; other < SBoardTables::CellCount; other++) {
+            if ((other != cell) && ((t.row[other] == t.row[cell]) || (t.col[other] == t.col[cell]) || (t.block[other] == t.block[cell])))
+                t.peers[cell][n++] = static_cast<uint8_t>(other);
+        }
+    }
+
+    // SplitMix64, from a fixed seed, so hashes are the same on every run
+    uint64_t state = 0x5344554B4F4B4559;
+    for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+        t.zobrist[cell][0] = 0;
+        for (int value = 1; value <= BOARD_SIZE; value++) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            t.zobrist[cell][value] = z ^ (z >> 31);
+        }
+    }
+
+    return t;
+}
+
+inline constexpr SBoardTables g_boardTables = MakeBoardTables();
+
+/**
+ * @brief Cross checks the tables against each other
+ */
+constexpr bool AreBoardTablesConsistent(const SBoardTables& t)
+{
+    for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+        // Every unit of a cell lists the cell
+        for (int u = 0; u < 3; u++) {
+            bool is_listed = false;
+            for (int pos = 0; pos < BOARD_SIZE; pos++) {
+                is_listed |= (t.cells[t.units[cell][u]][pos] == cell);
+            }
+            if (!is_listed)
+                return false;
+        }
+
+        // Peers are distinct, ascending, and share a unit with the cell
+        for (int p = 0; p < SBoardTables::PeerCount; p++) {
+            int peer = t.peers[cell][p];
+            if ((peer == cell) || ((p > 0) && (peer <= t.peers[cell][p - 1])))
+                return false;
+            if ((t.row[peer] != t.row[cell]) && (t.col[peer] != t.col[cell]) && (t.block[peer] != t.block[cell]))
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Number of set bits of a candidate mask
+ */
+constexpr int CountBits(unsigned int mask)
+{
+    int count = 0;
+    for (; mask; mask &= (mask - 1))
+        count++;
+    return count;
+}
+
+/**
+ * @brief Index of the lowest set bit of a non-zero mask, one less than the value of that candidate
+ */
+constexpr int LowestDigit(unsigned int mask)
+{
+    int digit = 0;
+    while (!(mask & (1u << digit)))
+        digit++;
+    return digit;
+}
+
+/**
+ * @brief The values of a board, with the values used by each row, column and block as masks
+ *
+ * Bit v - 1 of a mask is set if value v is used in the unit. This is the state
+ * of the small exhaustive searches (uniqueness checks, clue removal, solution
+ * enumeration), which place and remove values as they go and undo them on the
+ * way back.
+ */
+struct SUnitMasks
+{
+    static constexpr uint16_t AllCandidates = (1 << BOARD_SIZE) - 1;
+
+    uint8_t values[SBoardTables::CellCount];    // 0 - 9 in row order, 0 for empty
+    uint16_t rows[BOARD_SIZE];
+    uint16_t cols[BOARD_SIZE];
+    uint16_t blocks[BOARD_SIZE];
+
+    /**
+     * @brief Loads values 0 - 9 in row order
+     * @return False if a value is out of range or clashes with another
+     */
+    bool Load(const uint8_t* grid)
+    {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            rows[i] = cols[i] = blocks[i] = 0;
+        }
+
+        bool is_valid = true;
+        for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+            values[cell] = grid[cell];
+            if (grid[cell] == 0)
+                continue;
+            if (grid[cell] > BOARD_SIZE) {
+                values[cell] = 0;
+                is_valid = false;
+                continue;
+            }
+
+            uint16_t bit = static_cast<uint16_t>(1 << (grid[cell] - 1));
+            is_valid &= !(GetUsed(cell) & bit);
+            Place(cell, bit);
+        }
+        return is_valid;
+    }
+
+    uint16_t GetUsed(int cell) const
+    {
+        return rows[g_boardTables.row[cell]] | cols[g_boardTables.col[cell]] | blocks[g_boardTables.block[cell]];
+    }
+
+    uint16_t GetCandidates(int cell) const { return AllCandidates & ~GetUsed(cell); }
+
+    /**
+     * @brief Places the value of a candidate bit in a free cell
+     */
+    void Place(int cell, uint16_t bit)
+    {
+        values[cell] = static_cast<uint8_t>(LowestDigit(bit) + 1);
+        rows[g_boardTables.row[cell]] |= bit;
+        cols[g_boardTables.col[cell]] |= bit;
+        blocks[g_boardTables.block[cell]] |= bit;
+    }
+
+    /**
+     * @brief Empties a cell that holds a value
+     */
+    void Remove(int cell)
+    {
+        uint16_t bit = static_cast<uint16_t>(1 << (values[cell] - 1));
+        values[cell] = 0;
+        rows[g_boardTables.row[cell]] &= ~bit;
+        cols[g_boardTables.col[cell]] &= ~bit;
+        blocks[g_boardTables.block[cell]] &= ~bit;
+    }
+
+    /**
+     * @brief Returns the free cell with the fewest candidates, or -1 if there are none
+     * @param candidates Receives the candidates of the cell
+     * @param eliminated Candidates to leave out of each cell (optional)
+     */
+    int FindBranchCell(uint16_t& candidates, const uint16_t* eliminated = nullptr) const
+    {
+        int best_cell = -1;
+        int best_count = BOARD_SIZE + 1;
+        candidates = 0;
+
+        for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+            if (values[cell] != 0)
+                continue;
+
+            uint16_t mask = GetCandidates(cell);
+            if (eliminated)
+                mask &= ~eliminated[cell];
+            int count = CountBits(mask);
+            if (count < best_count) {
+                best_cell = cell;
+                best_count = count;
+                candidates = mask;
+                if (count <= 1)
+                    break;
+            }
+        }
+        return best_cell;
+    }
+
+    /**
+     * @brief Counts the completions of the board, stopping once `limit` have been found
+     *
+     * Always branches on the cell with the fewest candidates. The board is left
+     * as it was.
+     *
+     * @param eliminated Candidates to leave out of each cell (optional)
+     */
+    int CountCompletions(int limit, const uint16_t* eliminated = nullptr)
+    {
+        uint16_t candidates;
+        int cell = FindBranchCell(candidates, eliminated);
+        if (cell < 0)
+            return 1;
+
+        int found = 0;
+        for (; candidates && (found < limit); candidates &= (candidates - 1)) {
+            Place(cell, candidates & (0 - candidates));
+            found += CountCompletions(limit - found, eliminated);
+            Remove(cell);
+        }
+        return found;
+    }
+};
+
+static_assert(SBoardTables::PeerCount == 20, "9x9 board cells have 20 peers");
+static_assert(g_boardTables.row[80] == 8 && g_boardTables.col[80] == 8 && g_boardTables.block[80] == 8, "last cell");
+static_assert(g_boardTables.block[30] == 4 && g_boardTables.units[30][2] == SBoardTables::FirstBlockUnit + 4, "centre block");
+static_assert(g_boardTables.cells[SBoardTables::FirstBlockUnit + 4][0] == 30 && g_boardTables.cells[SBoardTables::FirstBlockUnit + 4][8] == 50, "block cells are in row order");
+static_assert(g_boardTables.cells[SBoardTables::FirstColumnUnit + 2][8] == 74, "column cells");
+static_assert(g_boardTables.peers[0][0] == 1 && g_boardTables.peers[0][8] == 9 && g_boardTables.peers[0][19] == 72, "peers of the first cell");
+static_assert(g_boardTables.zobrist[40][0] == 0 && g_boardTables.zobrist[40][1] != g_boardTables.zobrist[40][2], "zobrist keys");
+static_assert(AreBoardTablesConsistent(g_boardTables), "board tables are inconsistent");
+static_assert(CountBits(SUnitMasks::AllCandidates) == BOARD_SIZE && LowestDigit(0x10) == 4, "candidate bits");
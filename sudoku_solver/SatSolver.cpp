@@ -0,0 +1,453 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SatSolver.h"
+#include "SBoardTables.h"
+#include <algorithm>
+
+namespace {
+
+	constexpr int8_t VALUE_UNSET = 2;
+	constexpr uint64_t RESTART_UNIT = 32;			// conflicts per step of the Luby schedule
+	constexpr size_t MAX_LEARNTS = 2000;			// learnt clauses kept over a restart
+	constexpr double ACTIVITY_DECAY = 0.95;
+	constexpr double ACTIVITY_LIMIT = 1e100;
+
+	constexpr int Variable(int cell, int digit) { return cell * BOARD_SIZE + digit; }
+	constexpr int Positive(int variable) { return 2 * variable; }
+	constexpr int Negative(int variable) { return 2 * variable + 1; }
+
+	/*
+	* 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+	*/
+	uint64_t Luby(uint64_t index)
+	{
+		uint64_t size = 1;
+		int power = 0;
+		while (size < index + 1) {
+			size = 2 * size + 1;
+			power++;
+		}
+		while (size - 1 != index) {
+			size = (size - 1) >> 1;
+			power--;
+			index = index % size;
+		}
+		return uint64_t(1) << power;
+	}
+}
+
+/*
+* Only the values left open by the givens are encoded. Each given sets its
+* cell, and rules its value out of its peers, which leaves most variables
+* false before the search starts, and far fewer clauses.
+*/
+bool SatSolver::Load(const SBoard& board)
+{
+	m_literals.clear();
+	m_clauses.clear();
+	for (auto& watches : m_watches) {
+		watches.clear();
+	}
+	m_reasons.fill(-1);
+	m_levels.fill(0);
+	m_activity.fill(0.0);
+	m_phases.fill(1);
+	m_seen.fill(0);
+	m_activityStep = 1.0;
+	m_trail.clear();
+	m_trailLimits.clear();
+	m_queueHead = 0;
+
+	// Candidates, and the values placed in each unit
+	uint16_t candidates[SBoardTables::CellCount];
+	uint16_t placed[SBoardTables::UnitCount] = {};
+	std::fill(std::begin(candidates), std::end(candidates), uint16_t(0x1FF));
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		int value = static_cast<int>(board.GetCellDirect(cell).value);
+		if (value == 0)
+			continue;
+
+		uint16_t bit = static_cast<uint16_t>(1 << (value - 1));
+		if (!(candidates[cell] & bit))
+			return false;
+
+		candidates[cell] = bit;
+		for (auto peer : g_boardTables.peers[cell]) {
+			candidates[peer] &= ~bit;
+		}
+		for (auto unit : g_boardTables.units[cell]) {
+			placed[unit] |= bit;
+		}
+	}
+
+	// Given cells are set, and ruled out values are false, without clauses
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		bool is_given = (board.GetCellDirect(cell).value != SValueEnum::SValue_Empty);
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			bool is_open = !is_given && (candidates[cell] & (1 << digit));
+			m_values[Variable(cell, digit)] = is_open ? VALUE_UNSET : static_cast<int8_t>(is_given && (candidates[cell] & (1 << digit)));
+		}
+	}
+
+	// Exactly one of the open variables holds, for each free cell and for
+	// each value still to place in each unit.
+	int literals[BOARD_SIZE];
+	auto add_exactly_one = [this, &literals](int count) {
+		if (count == 0)
+			return false;
+
+		if (count == 1) {
+			if (GetValue(literals[0]) == VALUE_UNSET)
+				Assign(literals[0], -1);
+			return true;
+		}
+
+		AddClause(literals, count, false);
+		for (int i = 0; i < count; i++) {
+			for (int j = i + 1; j < count; j++) {
+				int pair[2] = { literals[i] ^ 1, literals[j] ^ 1 };
+				AddClause(pair, 2, false);
+			}
+		}
+		return true;
+	};
+
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		if (board.GetCellDirect(cell).value != SValueEnum::SValue_Empty)
+			continue;
+
+		int count = 0;
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			if (candidates[cell] & (1 << digit))
+				literals[count++] = Positive(Variable(cell, digit));
+		}
+		if (!add_exactly_one(count))
+			return false;
+	}
+
+	for (int unit = 0; unit < SBoardTables::UnitCount; unit++) {
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			if (placed[unit] & (1 << digit))
+				continue;
+
+			int count = 0;
+			for (auto cell : g_boardTables.cells[unit]) {
+				if (m_values[Variable(cell, digit)] != 0)
+					literals[count++] = Positive(Variable(cell, digit));
+			}
+			if (!add_exactly_one(count))
+				return false;
+		}
+	}
+	return true;
+}
+
+int SatSolver::AddClause(const int* literals, size_t size, bool is_learnt)
+{
+	int index = static_cast<int>(m_clauses.size());
+	m_clauses.push_back(SClause{ static_cast<uint32_t>(m_literals.size()), static_cast<uint32_t>(size), is_learnt });
+	m_literals.insert(m_literals.end(), literals, literals + size);
+	m_watches[literals[0]].push_back(index);
+	m_watches[literals[1]].push_back(index);
+	return index;
+}
+
+int SatSolver::GetValue(int literal) const
+{
+	int8_t value = m_values[literal >> 1];
+	return (value == VALUE_UNSET) ? VALUE_UNSET : (value ^ (literal & 1));
+}
+
+void SatSolver::Assign(int literal, int reason)
+{
+	int variable = literal >> 1;
+	m_values[variable] = static_cast<int8_t>((literal & 1) ^ 1);
+	m_levels[variable] = GetLevel();
+	m_reasons[variable] = reason;
+	m_trail.push_back(literal);
+}
+
+/*
+* Each clause in the watch list of a literal made false either finds another
+* literal to watch, or is unit on its other watched literal, or is a conflict.
+* The implied literal is always moved to the front of its clause, which
+* `Analyze()` relies on.
+*/
+int SatSolver::Propagate()
+{
+	while (m_queueHead < m_trail.size()) {
+		int false_literal = m_trail[m_queueHead++] ^ 1;
+		auto& watches = m_watches[false_literal];
+
+		size_t kept = 0;
+		for (size_t i = 0; i < watches.size(); i++) {
+			int index = watches[i];
+			const SClause& clause = m_clauses[index];
+			int* literals = &m_literals[clause.start];
+
+			if (literals[0] == false_literal)
+				std::swap(literals[0], literals[1]);
+
+			if (GetValue(literals[0]) == 1) {
+				watches[kept++] = index;
+				continue;
+			}
+
+			bool has_moved = false;
+			for (uint32_t k = 2; k < clause.size; k++) {
+				if (GetValue(literals[k]) != 0) {
+					std::swap(literals[1], literals[k]);
+					m_watches[literals[1]].push_back(index);
+					has_moved = true;
+					break;
+				}
+			}
+			if (has_moved)
+				continue;
+
+			watches[kept++] = index;
+			if (GetValue(literals[0]) == 0) {
+				while (++i < watches.size()) {
+					watches[kept++] = watches[i];
+				}
+				watches.resize(kept);
+				return index;
+			}
+			Assign(literals[0], index);
+		}
+		watches.resize(kept);
+	}
+	return -1;
+}
+
+/*
+* Resolves the conflict with the reasons of its literals set at the current
+* level, until only one is left (the first unique implication point). The
+* learnt clause is its negation and the literals from earlier levels.
+*/
+int SatSolver::Analyze(int conflict)
+{
+	m_learnt.clear();
+	m_learnt.push_back(0);
+
+	int path_count = 0;
+	int literal = -1;
+	size_t index = m_trail.size();
+	int reason = conflict;
+
+	do {
+		const SClause& clause = m_clauses[reason];
+		for (uint32_t j = (literal < 0) ? 0 : 1; j < clause.size; j++) {
+			int other = m_literals[clause.start + j];
+			int variable = other >> 1;
+			if (m_seen[variable] || (m_levels[variable] == 0))
+				continue;
+
+			m_seen[variable] = 1;
+			BumpActivity(variable);
+			if (m_levels[variable] == GetLevel()) {
+				path_count++;
+			}
+			else {
+				m_learnt.push_back(other);
+			}
+		}
+
+		while (!m_seen[m_trail[--index] >> 1]);
+		literal = m_trail[index];
+		reason = m_reasons[literal >> 1];
+		m_seen[literal >> 1] = 0;
+	} while (--path_count > 0);
+
+	m_learnt[0] = literal ^ 1;
+
+	int back_level = 0;
+	for (size_t i = 1; i < m_learnt.size(); i++) {
+		int level = m_levels[m_learnt[i] >> 1];
+		if (level > back_level) {
+			back_level = level;
+			std::swap(m_learnt[1], m_learnt[i]);
+		}
+	}
+	for (size_t i = 1; i < m_learnt.size(); i++) {
+		m_seen[m_learnt[i] >> 1] = 0;
+	}
+	return back_level;
+}
+
+void SatSolver::Backtrack(int level)
+{
+	if (GetLevel() <= level)
+		return;
+
+	size_t limit = m_trailLimits[level];
+	for (size_t i = m_trail.size(); i > limit; i--) {
+		int variable = m_trail[i - 1] >> 1;
+		m_phases[variable] = static_cast<uint8_t>(m_values[variable]);
+		m_values[variable] = VALUE_UNSET;
+	}
+	m_trail.resize(limit);
+	m_trailLimits.resize(level);
+	m_queueHead = limit;
+}
+
+void SatSolver::BumpActivity(int variable)
+{
+	m_activity[variable] += m_activityStep;
+	if (m_activity[variable] > ACTIVITY_LIMIT) {
+		for (auto& activity : m_activity) {
+			activity /= ACTIVITY_LIMIT;
+		}
+		m_activityStep /= ACTIVITY_LIMIT;
+	}
+}
+
+/*
+* The watches are rebuilt from scratch, so at level 0 each clause kept must
+* be watched by two literals that are not false. Clauses already satisfied
+* are dropped, and the false literals of the rest are left out.
+*/
+void SatSolver::ReduceLearnts()
+{
+	std::vector<int> learnts;
+	for (int i = 0; i < static_cast<int>(m_clauses.size()); i++) {
+		if (m_clauses[i].is_learnt)
+			learnts.push_back(i);
+	}
+	if (learnts.size() <= MAX_LEARNTS)
+		return;
+
+	std::stable_sort(learnts.begin(), learnts.end(), [this](int a, int b) { return m_clauses[a].size < m_clauses[b].size; });
+	std::vector<uint8_t> is_kept(m_clauses.size(), 1);
+	for (size_t i = learnts.size() / 2; i < learnts.size(); i++) {
+		is_kept[learnts[i]] = 0;
+	}
+
+	std::vector<int> literals;
+	std::vector<SClause> clauses;
+	literals.swap(m_literals);
+	clauses.swap(m_clauses);
+	for (auto& watches : m_watches) {
+		watches.clear();
+	}
+
+	std::vector<int> kept;
+	for (size_t i = 0; i < clauses.size(); i++) {
+		if (!is_kept[i])
+			continue;
+
+		kept.clear();
+		bool is_satisfied = false;
+		for (uint32_t j = 0; j < clauses[i].size; j++) {
+			int literal = literals[clauses[i].start + j];
+			int value = GetValue(literal);
+			is_satisfied |= (value == 1);
+			if (value != 0)
+				kept.push_back(literal);
+		}
+
+		// Units were set at level 0 when found, so every clause left has two free literals.
+		if (!is_satisfied && (kept.size() >= 2))
+			AddClause(kept.data(), kept.size(), clauses[i].is_learnt);
+	}
+
+	// Level 0 literals no longer have a reason clause
+	for (int literal : m_trail) {
+		m_reasons[literal >> 1] = -1;
+	}
+}
+
+bool SatSolver::Search(uint64_t max_conflicts, int& steps, SSolveStatus& status)
+{
+	uint64_t conflicts = 0;
+
+	while (true) {
+		int conflict = Propagate();
+		if (conflict >= 0) {
+			m_conflicts++;
+			conflicts++;
+			if (GetLevel() == 0) {
+				status = SSolveStatus::Unsolved;
+				return true;
+			}
+
+			int back_level = Analyze(conflict);
+			Backtrack(back_level);
+			if (m_learnt.size() == 1) {
+				Assign(m_learnt[0], -1);
+			}
+			else {
+				Assign(m_learnt[0], AddClause(m_learnt.data(), m_learnt.size(), true));
+			}
+			m_activityStep /= ACTIVITY_DECAY;
+			continue;
+		}
+
+		if (conflicts >= max_conflicts) {
+			Backtrack(0);
+			return false;
+		}
+
+		// Guess the most active free variable, with its last value
+		int variable = -1;
+		for (int v = 0; v < VariableCount; v++) {
+			if ((m_values[v] == VALUE_UNSET) && ((variable < 0) || (m_activity[v] > m_activity[variable])))
+				variable = v;
+		}
+		if (variable < 0) {
+			status = SSolveStatus::Solved;
+			return true;
+		}
+
+		m_nodes++;
+		if (m_budget.IsSpent(m_nodes, status))
+			return true;
+
+		steps++;
+		m_trailLimits.push_back(m_trail.size());
+		Assign(m_phases[variable] ? Positive(variable) : Negative(variable), -1);
+	}
+}
+
+bool SatSolver::Solve(const SBoard& board, SBoard* board_ptr, int& steps)
+{
+	return SolveWithStatus(board, board_ptr, steps) == SSolveStatus::Solved;
+}
+
+SSolveStatus SatSolver::SolveWithStatus(const SBoard& board, SBoard* board_ptr, int& steps)
+{
+	m_budget.Start(m_limits);
+	m_nodes = 0;
+	m_conflicts = 0;
+
+	SSolveStatus status = SSolveStatus::Unsolved;
+	if (Load(board)) {
+		for (uint64_t restart = 0; !Search(Luby(restart) * RESTART_UNIT, steps, status); restart++) {
+			ReduceLearnts();
+		}
+	}
+
+	if (board_ptr) {
+		if (status == SSolveStatus::Solved) {
+			*board_ptr = board;
+			for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+				if (board.GetCellDirect(cell).value != SValueEnum::SValue_Empty)
+					continue;
+
+				for (int digit = 0; digit < BOARD_SIZE; digit++) {
+					if (m_values[Variable(cell, digit)] == 1) {
+						board_ptr->SetCell(g_boardTables.col[cell], g_boardTables.row[cell], SCell{ static_cast<SValueEnum>(digit + 1), SStateEnum::SState_Solved });
+						break;
+					}
+				}
+			}
+		}
+		else {
+			board_ptr->ClearBoard();
+		}
+	}
+	return status;
+}
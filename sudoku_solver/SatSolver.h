@@ -0,0 +1,150 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SudokuSolver.h"
+#include <array>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @class SatSolver
+ * @brief Solves a board as a boolean formula, with conflict-driven clause learning
+ *
+ * There is a variable for each value of each cell, true if the cell holds the
+ * value. Each cell, and each value of each unit, is exactly one of its
+ * variables: one clause that at least one holds, and a binary clause for each
+ * pair that not both hold. Values ruled out by the givens are false from the
+ * start, and left out of the clauses.
+ *
+ * Clauses are found unit through two watched literals. Each conflict adds a
+ * clause learnt from its first unique implication point, and the search jumps
+ * back to the level at which that clause becomes unit, rather than to the last
+ * guess. Variables are guessed by activity (bumped by conflicts), with their
+ * last value, and the search restarts on a Luby schedule. Unlike chronological
+ * backtracking, the same conflict is never found twice under other guesses.
+ *
+ * Guesses are the search nodes counted against the limits. Everything is
+ * deterministic, so results are reproducible.
+ */
+class SatSolver
+{
+public:
+
+    /**
+     * @brief Solves a Sudoku board
+     * @param board The Sudoku board to solve. It is not changed.
+     * @param board_ptr Receives the solved board (optional)
+     * @param steps The number of steps taken to solve the board
+     * @return True if the board is solved, false otherwise
+     */
+    bool Solve(const SBoard& board, SBoard* board_ptr, int& steps);
+
+    /**
+     * @brief As above, but reports why a board was not solved
+     */
+    SSolveStatus SolveWithStatus(const SBoard& board, SBoard* board_ptr, int& steps);
+
+    void SetLimits(const SSolveLimits& limits) { m_limits = limits; }
+
+    const SSolveLimits& GetLimits() const { return m_limits; }
+
+    /**
+     * @brief Number of search nodes (guesses) of the last solve
+     */
+    uint64_t GetNodeCount() const { return m_nodes; }
+
+    /**
+     * @brief Number of conflicts, and so of learnt clauses, of the last solve
+     */
+    uint64_t GetConflictCount() const { return m_conflicts; }
+
+    static constexpr int VariableCount = BOARD_SIZE * BOARD_SIZE * BOARD_SIZE;
+
+protected:
+
+    // A literal is (2 * variable) for the variable, (2 * variable + 1) for its negation
+    struct SClause
+    {
+        uint32_t start;         // first literal in m_literals
+        uint32_t size;
+        bool is_learnt;
+    };
+
+    SSolveLimits m_limits;
+
+    // The formula. Each clause is watched by its first two literals.
+    std::vector<int> m_literals;
+    std::vector<SClause> m_clauses;
+    std::array<std::vector<int>, 2 * VariableCount> m_watches;     // clauses watching each literal
+
+    // The assignment
+    std::array<int8_t, VariableCount> m_values;    // 0, 1 or VALUE_UNSET
+    std::array<int, VariableCount> m_levels;
+    std::array<int, VariableCount> m_reasons;      // clause that implied the value, -1 for guesses
+    std::vector<int> m_trail;                      // literals in the order they were set
+    std::vector<size_t> m_trailLimits;             // start of each guess level in the trail
+    size_t m_queueHead = 0;                        // next trail literal to propagate
+
+    // Guessing
+    std::array<double, VariableCount> m_activity;
+    std::array<uint8_t, VariableCount> m_phases;   // last value of each variable
+    std::array<uint8_t, VariableCount> m_seen;
+    double m_activityStep = 1.0;
+    std::vector<int> m_learnt;
+
+    // State of the current solve
+    SSolveBudget m_budget;
+    uint64_t m_nodes = 0;
+    uint64_t m_conflicts = 0;
+
+    /**
+     * @brief Clears the previous solve, and encodes the board
+     * @return False if the givens already leave the board without a solution
+     */
+    bool Load(const SBoard& board);
+
+    /**
+     * @brief Adds a clause of at least two literals, watching the first two
+     * @return The index of the clause
+     */
+    int AddClause(const int* literals, size_t size, bool is_learnt);
+
+    int GetLevel() const { return static_cast<int>(m_trailLimits.size()); }
+
+    int GetValue(int literal) const;
+
+    void Assign(int literal, int reason);
+
+    /**
+     * @brief Sets the literals made unit by the trail
+     * @return The index of a clause with all literals false, or -1
+     */
+    int Propagate();
+
+    /**
+     * @brief Learns a clause from the conflict, into `m_learnt`, asserting literal first
+     * @return The level to jump back to
+     */
+    int Analyze(int conflict);
+
+    void Backtrack(int level);
+
+    void BumpActivity(int variable);
+
+    /**
+     * @brief Drops the longer half of the learnt clauses. Only called at level 0.
+     */
+    void ReduceLearnts();
+
+    /**
+     * @brief Searches until solved, proven unsolvable, or the budget is spent
+     * @param max_conflicts Conflicts before the search returns to level 0 to restart
+     * @param status Receives the outcome, when the search is done
+     * @return False if it is time to restart
+     */
+    bool Search(uint64_t max_conflicts, int& steps, SSolveStatus& status);
+};
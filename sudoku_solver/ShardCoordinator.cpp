@@ -0,0 +1,307 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "ShardCoordinator.h"
+#include <filesystem>
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	constexpr size_t COPY_BUFFER_SIZE = 1024 * 1024;
+
+#ifdef _WIN32
+	/*
+	* Quotes an argument so that it is parsed back as one, by the rules of
+	* CommandLineToArgvW: backslashes are only special before a quote.
+	*/
+	void AppendArgument(std::wstring& command_line, const std::wstring& argument)
+	{
+		if (!command_line.empty())
+			command_line += L' ';
+
+		if (!argument.empty() && (argument.find_first_of(L" \t\"") == std::wstring::npos)) {
+			command_line += argument;
+			return;
+		}
+
+		command_line += L'"';
+		size_t backslashes = 0;
+		for (auto c : argument) {
+			if (c == L'\\') {
+				backslashes++;
+				continue;
+			}
+			if (c == L'"')
+				backslashes = backslashes * 2 + 1;
+			command_line.append(backslashes, L'\\');
+			command_line += c;
+			backslashes = 0;
+		}
+		command_line.append(backslashes * 2, L'\\');
+		command_line += L'"';
+	}
+#endif
+
+	bool AppendFile(const std::string& path, FILE* output, std::vector<char>& buffer)
+	{
+		FILE* input = std::fopen(path.c_str(), "rb");
+		if (input == nullptr)
+			return false;
+
+		bool is_ok = true;
+		size_t size;
+		while ((size = std::fread(buffer.data(), 1, buffer.size(), input)) > 0) {
+			if (std::fwrite(buffer.data(), 1, size, output) != size) {
+				is_ok = false;
+				break;
+			}
+		}
+		is_ok &= !std::ferror(input);
+		std::fclose(input);
+		return is_ok;
+	}
+}
+
+std::string ShardCoordinator::GetPartPath(int index) const
+{
+	const auto& base = m_options.output_path.empty() ? m_options.input_path : m_options.output_path;
+	return base + ".part" + std::to_string(index);
+}
+
+std::string ShardCoordinator::GetCheckpointPath(int index) const
+{
+	return GetPartPath(index) + ".ckpt";
+}
+
+/*
+* Workers are started all at once, and any that fails is started again while
+* the others run.
+*/
+bool ShardCoordinator::Run()
+{
+	m_stats = SBatchStats{};
+	m_restartCount = 0;
+	if ((m_options.count < 1) || (m_options.count > MaxShards) || m_options.input_path.empty())
+		return false;
+
+	m_workers.assign(m_options.count, SWorker{});
+	for (int i = 0; i < m_options.count; i++) {
+		if (!StartWorker(i, m_options.resume)) {
+			StopWorkers();
+			return false;
+		}
+	}
+
+	int running = m_options.count;
+	bool is_ok = true;
+	while (running > 0) {
+		int index = 0;
+		if (WaitForWorker(index)) {
+			running--;
+			continue;
+		}
+
+		if ((index < 0) || (m_workers[index].restarts >= m_options.max_restarts) || !StartWorker(index, true)) {
+			is_ok = false;
+			break;
+		}
+		m_workers[index].restarts++;
+		m_restartCount++;
+	}
+
+	if (!is_ok) {
+		StopWorkers();
+		return false;
+	}
+
+	if (!Merge())
+		return false;
+
+	RemoveParts();
+	return true;
+}
+
+/*
+* A worker resumes only if its checkpoint can be read. Otherwise it starts the
+* shard again from the beginning, replacing its part.
+*/
+bool ShardCoordinator::StartWorker(int index, bool resume)
+{
+	SBatchCheckpoint checkpoint;
+	std::string checkpoint_path = GetCheckpointPath(index);
+	if (resume) {
+		resume = BatchRunner::LoadCheckpoint(checkpoint_path, checkpoint);
+	}
+	else {
+		std::error_code ec;
+		std::filesystem::remove(checkpoint_path, ec);
+	}
+
+	std::vector<std::wstring> arguments = m_options.arguments;
+	arguments.push_back(L"--shard");
+	arguments.push_back(std::to_wstring(index) + L"/" + std::to_wstring(m_options.count));
+	arguments.push_back(L"-o");
+	arguments.push_back(std::filesystem::path(GetPartPath(index)).wstring());
+	arguments.push_back(L"-k");
+	arguments.push_back(std::filesystem::path(checkpoint_path).wstring());
+	if (resume)
+		arguments.push_back(L"--resume");
+	arguments.push_back(std::filesystem::path(m_options.input_path).wstring());
+
+#ifdef _WIN32
+	std::wstring command_line;
+	AppendArgument(command_line, m_options.program);
+	for (const auto& argument : arguments) {
+		AppendArgument(command_line, argument);
+	}
+
+	STARTUPINFOW startup_info{};
+	startup_info.cb = sizeof(startup_info);
+	PROCESS_INFORMATION process_info{};
+	if (!CreateProcessW(nullptr, &command_line[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup_info, &process_info))
+		return false;
+
+	CloseHandle(process_info.hThread);
+	m_workers[index].process = reinterpret_cast<intptr_t>(process_info.hProcess);
+#else
+	// The strings are converted before the fork, as only exec is safe after it.
+	std::vector<std::string> strings;
+	strings.push_back(std::filesystem::path(m_options.program).string());
+	for (const auto& argument : arguments) {
+		strings.push_back(std::filesystem::path(argument).string());
+	}
+	std::vector<char*> argv;
+	for (auto& s : strings) {
+		argv.push_back(&s[0]);
+	}
+	argv.push_back(nullptr);
+
+	pid_t pid = fork();
+	if (pid < 0)
+		return false;
+
+	if (pid == 0) {
+		execvp(argv[0], argv.data());
+		_exit(127);
+	}
+	m_workers[index].process = pid;
+#endif
+	return true;
+}
+
+bool ShardCoordinator::WaitForWorker(int& index)
+{
+	index = -1;
+
+#ifdef _WIN32
+	HANDLE handles[MaxShards];
+	int indices[MaxShards];
+	DWORD count = 0;
+	for (int i = 0; i < static_cast<int>(m_workers.size()); i++) {
+		if (m_workers[i].process != 0) {
+			handles[count] = reinterpret_cast<HANDLE>(m_workers[i].process);
+			indices[count++] = i;
+		}
+	}
+
+	DWORD result = WaitForMultipleObjects(count, handles, FALSE, INFINITE);
+	if ((result < WAIT_OBJECT_0) || (result >= WAIT_OBJECT_0 + count))
+		return false;
+
+	index = indices[result - WAIT_OBJECT_0];
+	DWORD exit_code = 1;
+	GetExitCodeProcess(handles[result - WAIT_OBJECT_0], &exit_code);
+	CloseHandle(handles[result - WAIT_OBJECT_0]);
+	m_workers[index].process = 0;
+	return (exit_code == 0);
+#else
+	for (;;) {
+		int status = 0;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0)
+			return false;
+
+		for (int i = 0; i < static_cast<int>(m_workers.size()); i++) {
+			if (m_workers[i].process == pid) {
+				index = i;
+				m_workers[i].process = 0;
+				return WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+			}
+		}
+	}
+#endif
+}
+
+void ShardCoordinator::StopWorkers()
+{
+	for (auto& worker : m_workers) {
+		if (worker.process == 0)
+			continue;
+
+#ifdef _WIN32
+		HANDLE process = reinterpret_cast<HANDLE>(worker.process);
+		TerminateProcess(process, 1);
+		WaitForSingleObject(process, INFINITE);
+		CloseHandle(process);
+#else
+		pid_t pid = static_cast<pid_t>(worker.process);
+		kill(pid, SIGTERM);
+		waitpid(pid, nullptr, 0);
+#endif
+		worker.process = 0;
+	}
+}
+
+bool ShardCoordinator::Merge()
+{
+	for (int i = 0; i < m_options.count; i++) {
+		SBatchCheckpoint checkpoint;
+		if (!BatchRunner::LoadCheckpoint(GetCheckpointPath(i), checkpoint))
+			return false;
+
+		m_stats.lines += checkpoint.stats.lines;
+		m_stats.solved += checkpoint.stats.solved;
+		m_stats.unsolved += checkpoint.stats.unsolved;
+		m_stats.invalid += checkpoint.stats.invalid;
+		m_stats.aborted += checkpoint.stats.aborted;
+	}
+
+	FILE* output = m_options.output_path.empty() ? stdout : std::fopen(m_options.output_path.c_str(), "wb");
+	if (output == nullptr)
+		return false;
+
+	std::vector<char> buffer(COPY_BUFFER_SIZE);
+	bool is_ok = true;
+	for (int i = 0; (i < m_options.count) && is_ok; i++) {
+		is_ok = AppendFile(GetPartPath(i), output, buffer);
+	}
+
+	if (output == stdout) {
+		is_ok &= (std::fflush(output) == 0);
+	}
+	else {
+		is_ok &= (std::fclose(output) == 0);
+	}
+	return is_ok;
+}
+
+void ShardCoordinator::RemoveParts() const
+{
+	for (int i = 0; i < m_options.count; i++) {
+		std::error_code ec;
+		std::filesystem::remove(GetPartPath(i), ec);
+		std::filesystem::remove(GetCheckpointPath(i), ec);
+	}
+}
@@ -0,0 +1,115 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "BatchRunner.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Settings for `ShardCoordinator`
+ */
+struct SShardOptions
+{
+    std::wstring program;               // the solver executable, run once per shard
+    std::vector<std::wstring> arguments;    // batch options passed to every shard (e.g. -b -e -t 5)
+    std::string input_path;             // the file to split
+    std::string output_path;            // the merged output, stdout if empty
+    int count = 2;                      // worker processes, at most `MaxShards`
+    int max_restarts = 1;               // times a failed worker is started again
+    bool resume = false;                // continue the shards of an earlier run from their checkpoints
+};
+
+/**
+ * @class ShardCoordinator
+ * @brief Splits a batch run over several worker processes, and merges their output
+ *
+ * The input file is split into byte ranges of equal size, one per worker (see
+ * `BatchRunner::GetShardRange()`). Each worker is the solver itself, run with
+ * `--shard i/N`, and writes its lines to a part file next to the output, with
+ * a checkpoint file next to that.
+ *
+ * A worker that fails is started again from its last checkpoint. Once all have
+ * finished, the parts are joined in order into the output, which then holds the
+ * same lines as a single process run, and the statistics are summed from the
+ * final checkpoints. The part and checkpoint files are then removed. If a worker
+ * cannot be finished they are kept, so that the run can be resumed.
+ *
+ * Workers do not share memory, so a crash or leak in one is contained to its
+ * shard.
+ */
+class ShardCoordinator
+{
+public:
+
+    static constexpr int MaxShards = 64;
+
+    explicit ShardCoordinator(const SShardOptions& options) : m_options(options) {}
+
+    /**
+     * @brief Runs the workers until all have finished, and merges their output
+     * @return False if a worker could not be finished, or the merge failed
+     */
+    bool Run();
+
+    /**
+     * @brief The statistics of all shards, once `Run()` has succeeded
+     */
+    const SBatchStats& GetStats() const { return m_stats; }
+
+    /**
+     * @brief Number of times a worker was started again after failing
+     */
+    int GetRestartCount() const { return m_restartCount; }
+
+    /**
+     * @brief The file written by the worker of a shard
+     */
+    std::string GetPartPath(int index) const;
+
+    /**
+     * @brief The checkpoint file of the worker of a shard
+     */
+    std::string GetCheckpointPath(int index) const;
+
+protected:
+
+    struct SWorker
+    {
+        intptr_t process = 0;       // process handle (Windows) or id, 0 when not running
+        int restarts = 0;
+    };
+
+    SShardOptions m_options;
+    std::vector<SWorker> m_workers;
+    SBatchStats m_stats;
+    int m_restartCount = 0;
+
+    /**
+     * @brief Starts the worker of a shard, from its checkpoint if resuming
+     */
+    bool StartWorker(int index, bool resume);
+
+    /**
+     * @brief Waits for any running worker to exit
+     * @param index Receives the shard of the worker
+     * @return True if the worker succeeded
+     */
+    bool WaitForWorker(int& index);
+
+    /**
+     * @brief Stops any workers still running, after a failure
+     */
+    void StopWorkers();
+
+    /**
+     * @brief Joins the parts in order into the output, and sums their statistics
+     */
+    bool Merge();
+
+    void RemoveParts() const;
+};
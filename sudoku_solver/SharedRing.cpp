@@ -0,0 +1,338 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SharedRing.h"
+#include "SBoardTables.h"
+#include "SudokuSolver.h"
+#include "PuzzleParser.h"
+#include <thread>
+#include <chrono>
+#include <new>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace {
+
+	constexpr uint32_t RING_MAGIC = 0x53524E47;		// 'SRNG'
+	constexpr uint32_t RING_VERSION = 1;
+	constexpr int SPIN_LIMIT = 1024;				// spins before an idle worker sleeps
+	constexpr auto MIN_IDLE_SLEEP = std::chrono::microseconds(50);	// first sleep of an idle worker, doubled each time
+	constexpr auto MAX_IDLE_SLEEP = std::chrono::milliseconds(1);	// and at most this, the latency once idle
+
+	enum SlotState : uint32_t {
+		SlotState_Free = 0,
+		SlotState_Submitted = 1,
+		SlotState_Completed = 2
+	};
+
+	// The atomics are shared between processes, which requires them to be
+	// lock free (and therefore address free).
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock free");
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics must be lock free");
+
+	std::string GetObjectName(const std::string& name)
+	{
+#ifdef _WIN32
+		return "Local\\ssolve_" + name;
+#else
+		return "/ssolve_" + name;
+#endif
+	}
+}
+
+// Counters are kept on separate cache lines, as they are written by
+// different sides of the ring.
+struct SharedRing::Header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity;
+	uint32_t mask;
+	alignas(64) std::atomic<uint64_t> submit_head;		// written by the producer
+	alignas(64) std::atomic<uint64_t> claim_tail;		// written by the workers
+	alignas(64) std::atomic<uint64_t> complete_tail;	// written by the producer
+	alignas(64) std::atomic<uint32_t> shutdown;
+};
+
+struct alignas(64) SharedRing::Slot {
+	std::atomic<uint32_t> state;
+	SRingStatus status;
+	uint32_t steps;
+	uint64_t user_data;
+	char puzzle[SBoardTables::CellCount];
+	char solution[SBoardTables::CellCount];
+};
+
+SharedRing::SharedRing()
+{
+}
+
+SharedRing::~SharedRing()
+{
+	Close();
+}
+
+bool SharedRing::Create(const std::string& name, uint32_t capacity)
+{
+	Close();
+
+	uint32_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+
+	if (!Map(GetObjectName(name), sizeof(Header) + size * sizeof(Slot), true))
+		return false;
+
+	m_isOwner = true;
+	m_name = name;
+
+	new (m_header) Header{};
+	m_header->capacity = size;
+	m_header->mask = size - 1;
+	for (uint32_t i = 0; i < size; i++) {
+		new (&m_slots[i]) Slot{};
+	}
+
+	// Only publish the magic once the rest of the header is valid.
+	m_header->version = RING_VERSION;
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->magic = RING_MAGIC;
+	return true;
+}
+
+bool SharedRing::Open(const std::string& name)
+{
+	Close();
+
+	if (!Map(GetObjectName(name), 0, false))
+		return false;
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if ((m_header->magic != RING_MAGIC) || (m_header->version != RING_VERSION) ||
+		(m_size < sizeof(Header) + m_header->capacity * sizeof(Slot))) {
+		Close();
+		return false;
+	}
+
+	m_name = name;
+	return true;
+}
+
+#ifdef _WIN32
+
+bool SharedRing::Map(const std::string& name, size_t size, bool create)
+{
+	HANDLE mapping;
+	if (create) {
+		mapping = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+			static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), name.c_str());
+		if ((mapping != nullptr) && (::GetLastError() == ERROR_ALREADY_EXISTS)) {
+			::CloseHandle(mapping);
+			return false;
+		}
+	}
+	else {
+		mapping = ::OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+	}
+
+	if (mapping == nullptr)
+		return false;
+
+	void* view = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (view == nullptr) {
+		::CloseHandle(mapping);
+		return false;
+	}
+
+	MEMORY_BASIC_INFORMATION info;
+	::VirtualQuery(view, &info, sizeof(info));
+
+	m_mapping = mapping;
+	m_size = create ? size : info.RegionSize;
+	m_header = static_cast<Header*>(view);
+	m_slots = reinterpret_cast<Slot*>(m_header + 1);
+	return true;
+}
+
+void SharedRing::Close()
+{
+	if (m_header != nullptr) {
+		::UnmapViewOfFile(m_header);
+		::CloseHandle(static_cast<HANDLE>(m_mapping));
+	}
+	m_header = nullptr;
+	m_slots = nullptr;
+	m_mapping = nullptr;
+	m_size = 0;
+	m_isOwner = false;
+}
+
+#else
+
+bool SharedRing::Map(const std::string& name, size_t size, bool create)
+{
+	int fd = create ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) : shm_open(name.c_str(), O_RDWR, 0);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if ((create && (ftruncate(fd, static_cast<off_t>(size)) != 0)) || (fstat(fd, &info) != 0) ||
+		(static_cast<size_t>(info.st_size) < sizeof(Header))) {
+		close(fd);
+		if (create)
+			shm_unlink(name.c_str());
+		return false;
+	}
+
+	size = static_cast<size_t>(info.st_size);
+	void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED) {
+		if (create)
+			shm_unlink(name.c_str());
+		return false;
+	}
+
+	m_size = size;
+	m_header = static_cast<Header*>(view);
+	m_slots = reinterpret_cast<Slot*>(m_header + 1);
+	return true;
+}
+
+void SharedRing::Close()
+{
+	if (m_header != nullptr) {
+		munmap(m_header, m_size);
+		if (m_isOwner)
+			shm_unlink(GetObjectName(m_name).c_str());
+	}
+	m_header = nullptr;
+	m_slots = nullptr;
+	m_size = 0;
+	m_isOwner = false;
+}
+
+#endif
+
+uint32_t SharedRing::GetCapacity() const
+{
+	return m_header ? m_header->capacity : 0;
+}
+
+bool SharedRing::Submit(const char* puzzle, uint64_t user_data)
+{
+	uint64_t head = m_header->submit_head.load(std::memory_order_relaxed);
+	Slot& slot = m_slots[head & m_header->mask];
+
+	// The slot is free once its previous result has been reaped.
+	if (slot.state.load(std::memory_order_acquire) != SlotState_Free)
+		return false;
+
+	std::memcpy(slot.puzzle, puzzle, SBoardTables::CellCount);
+	slot.user_data = user_data;
+	slot.state.store(SlotState_Submitted, std::memory_order_relaxed);
+	m_header->submit_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+bool SharedRing::Reap(SRingResult& result)
+{
+	uint64_t tail = m_header->complete_tail.load(std::memory_order_relaxed);
+	if (tail == m_header->submit_head.load(std::memory_order_relaxed))
+		return false;
+
+	Slot& slot = m_slots[tail & m_header->mask];
+	if (slot.state.load(std::memory_order_acquire) != SlotState_Completed)
+		return false;
+
+	result.user_data = slot.user_data;
+	result.status = slot.status;
+	result.steps = slot.steps;
+	std::memcpy(result.solution, slot.solution, SBoardTables::CellCount);
+
+	slot.state.store(SlotState_Free, std::memory_order_release);
+	m_header->complete_tail.store(tail + 1, std::memory_order_relaxed);
+	return true;
+}
+
+SharedRing::Slot* SharedRing::Claim()
+{
+	uint64_t tail = m_header->claim_tail.load(std::memory_order_relaxed);
+	while (tail < m_header->submit_head.load(std::memory_order_acquire)) {
+		if (m_header->claim_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			return &m_slots[tail & m_header->mask];
+	}
+	return nullptr;
+}
+
+void SharedRing::RunWorker(const SSolveLimits& limits /*= {}*/)
+{
+	SudokuSolver solver;
+	solver.SetLimits(limits);
+	SBoard board;
+	SBoard solved_board;
+	SParsedPuzzle parsed;
+	int spins = 0;
+	std::chrono::microseconds idle_sleep = MIN_IDLE_SLEEP;
+
+	while (true) {
+		Slot* slot = Claim();
+		if (slot == nullptr) {
+			if (m_header->shutdown.load(std::memory_order_acquire))
+				return;
+
+			// Spin without a syscall while puzzles are coming in, then sleep
+			// for longer and longer once the ring stays empty.
+			if (++spins < SPIN_LIMIT) {
+				CPU_RELAX();
+			}
+			else {
+				std::this_thread::sleep_for(idle_sleep);
+				idle_sleep = (idle_sleep * 2 < MAX_IDLE_SLEEP) ? idle_sleep * 2 : std::chrono::microseconds(MAX_IDLE_SLEEP);
+			}
+			continue;
+		}
+		spins = 0;
+		idle_sleep = MIN_IDLE_SLEEP;
+
+		// Parse the narrow layout directly. Bad characters or duplicate givens
+		// make the request invalid.
+		int steps = 0;
+		slot->status = SRingStatus::Invalid;
+		if (PuzzleParser::Parse(std::string_view(slot->puzzle, SBoardTables::CellCount), parsed) == SParseResult::Ok) {
+			parsed.ToBoard(board);
+			auto result = solver.SolveWithStatus(board, &solved_board, steps);
+			if (result == SSolveStatus::Solved) {
+				slot->status = SRingStatus::Solved;
+				solver.GetBoardAsStringLayout(solved_board, slot->solution);
+			}
+			else {
+				slot->status = (result == SSolveStatus::Unsolved) ? SRingStatus::Unsolved : SRingStatus::Aborted;
+			}
+		}
+		slot->steps = static_cast<uint32_t>(steps);
+		slot->state.store(SlotState_Completed, std::memory_order_release);
+	}
+}
+
+void SharedRing::Shutdown()
+{
+	m_header->shutdown.store(1, std::memory_order_release);
+}
@@ -0,0 +1,130 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoard.h"
+#include "SudokuSolver.h"
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Result of a request read back from a `SharedRing`
+ */
+enum class SRingStatus : uint32_t {
+    Solved = 1,
+    Unsolved = 2,
+    Invalid = 3,
+    Aborted = 4         // the solve ran out of budget
+};
+
+struct SRingResult
+{
+    uint64_t user_data;                              // as passed to Submit()
+    SRingStatus status;
+    uint32_t steps;
+    char solution[BOARD_SIZE * BOARD_SIZE];          // valid if solved
+};
+
+/**
+ * @class SharedRing
+ * @brief Shared memory submission/completion ring between a producer and solver workers
+ *
+ * The producer and the workers may live in different processes. Puzzles are
+ * written straight into a ring slot as 81 narrow characters (same notation as
+ * `LoadBoardFromStringLayout()`), and workers write the solution back into the
+ * same slot. Nothing is copied through the kernel, and no system calls are
+ * made while there is work to do.
+ *
+ * Protocol (one producer, any number of workers):
+ *  - The producer fills the slot at `submit_head` once it has been reaped, then
+ *    publishes it by advancing `submit_head`.
+ *  - Workers claim slots by advancing `claim_tail` with a compare-and-swap, and
+ *    mark the slot completed once solved.
+ *  - The producer reaps completed slots in submission order from `complete_tail`,
+ *    which frees them for reuse.
+ */
+class SharedRing
+{
+public:
+
+    SharedRing();
+    ~SharedRing();
+
+    SharedRing(const SharedRing&) = delete;
+    SharedRing& operator=(const SharedRing&) = delete;
+
+    /**
+     * @brief Creates a new named ring (producer side)
+     * @param name Name of the shared memory object
+     * @param capacity Number of slots. Rounded up to a power of two.
+     */
+    bool Create(const std::string& name, uint32_t capacity);
+
+    /**
+     * @brief Opens an existing ring (worker side)
+     */
+    bool Open(const std::string& name);
+
+    /**
+     * @brief Unmaps the ring. The creator also removes the name.
+     */
+    void Close();
+
+    /**
+     * @brief Writes a puzzle into the next free slot
+     * @param puzzle 81 layout characters, no terminator required
+     * @param user_data Returned with the result
+     * @return False if the ring is full
+     */
+    bool Submit(const char* puzzle, uint64_t user_data);
+
+    /**
+     * @brief Takes the next result, in submission order
+     * @return False if the next result is not ready yet
+     */
+    bool Reap(SRingResult& result);
+
+    /**
+     * @brief Solves submitted puzzles until `Shutdown()` is called
+     *
+     * Can be called from any number of threads, in any number of processes.
+     * Idle workers spin briefly, without a syscall, and then sleep for longer
+     * and longer, up to 1 ms, until a puzzle is submitted.
+     *
+     * @param limits Budgets for each puzzle. Puzzles that run out are reported
+     *               as `SRingStatus::Aborted`.
+     */
+    void RunWorker(const SSolveLimits& limits = {});
+
+    /**
+     * @brief Tells all workers to return once the ring is empty
+     */
+    void Shutdown();
+
+    uint32_t GetCapacity() const;
+    bool IsOpen() const { return m_header != nullptr; }
+
+protected:
+
+    struct Header;
+    struct Slot;
+
+    Header* m_header = nullptr;
+    Slot* m_slots = nullptr;
+    size_t m_size = 0;
+    void* m_mapping = nullptr;
+    bool m_isOwner = false;
+    std::string m_name;
+
+    bool Map(const std::string& name, size_t size, bool create);
+
+    /**
+     * @brief Claims the next submitted slot
+     * @return nullptr if there is nothing to claim
+     */
+    Slot* Claim();
+};
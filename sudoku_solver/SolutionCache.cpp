@@ -0,0 +1,134 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SolutionCache.h"
+#include "SBoardTables.h"
+#include <algorithm>
+#include <cstring>
+
+SolutionCache::SolutionCache(size_t memory_budget, int shard_count)
+{
+	shard_count = std::max(shard_count, 1);
+	for (int i = 0; i < shard_count; i++) {
+		m_shards.push_back(std::make_unique<Shard>());
+	}
+
+	// Always allow at least one entry per shard, otherwise the cache would
+	// never hit.
+	m_capacityPerShard = std::max<size_t>(memory_budget / GetEntrySize() / shard_count, 1);
+}
+
+size_t SolutionCache::GetEntrySize()
+{
+	// list node (entry + 2 links) and hash map node (key, iterator, next link
+	// and cached hash), plus a bucket pointer.
+	return (sizeof(Entry) + 2 * sizeof(void*))
+		+ (sizeof(uint64_t) + sizeof(std::list<Entry>::iterator) + 2 * sizeof(void*))
+		+ sizeof(void*);
+}
+
+/*
+* FNV-1a over the layout, eight characters at a time, then mixed so that both
+* the shard (high bits) and the map bucket (low bits) depend on every cell.
+*/
+uint64_t SolutionCache::HashLayout(const char* layout)
+{
+	uint64_t hash = 14695981039346656037ull;
+	int i = 0;
+	for (; i + 8 <= SBoardTables::CellCount; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, layout + i, sizeof(word));
+		hash ^= word;
+		hash *= 1099511628211ull;
+	}
+	for (; i < SBoardTables::CellCount; i++) {
+		hash ^= static_cast<uint8_t>(layout[i]);
+		hash *= 1099511628211ull;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+bool SolutionCache::Lookup(const char* layout, char* solution, int& steps, bool& solved)
+{
+	uint64_t key = HashLayout(layout);
+	Shard& shard = GetShard(key);
+
+	{
+		std::lock_guard<std::mutex> guard(shard.lock);
+
+		auto it = shard.index.find(key);
+		if ((it != shard.index.end()) && (std::memcmp(layout, it->second->layout, SBoardTables::CellCount) == 0)) {
+
+			// move to the front of the LRU list
+			shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+
+			const Entry& entry = *it->second;
+			solved = entry.solved;
+			steps = entry.steps;
+			if (entry.solved)
+				std::memcpy(solution, entry.solution, SBoardTables::CellCount);
+
+			m_hits.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	m_misses.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+void SolutionCache::Insert(const char* layout, const char* solution, int steps, bool solved)
+{
+	uint64_t key = HashLayout(layout);
+	Shard& shard = GetShard(key);
+	std::lock_guard<std::mutex> guard(shard.lock);
+
+	auto it = shard.index.find(key);
+	if (it != shard.index.end()) {
+		// Either a repeated insert, or a colliding layout. Both replace the
+		// existing entry.
+		shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+	}
+	else {
+		if (shard.entries.size() >= m_capacityPerShard) {
+			shard.index.erase(shard.entries.back().key);
+			shard.entries.pop_back();
+			m_evictions.fetch_add(1, std::memory_order_relaxed);
+		}
+		shard.entries.emplace_front();
+		shard.index[key] = shard.entries.begin();
+	}
+
+	Entry& entry = shard.entries.front();
+	entry.key = key;
+	entry.steps = steps;
+	entry.solved = solved && (solution != nullptr);
+	std::memcpy(entry.layout, layout, SBoardTables::CellCount);
+	if (entry.solved)
+		std::memcpy(entry.solution, solution, SBoardTables::CellCount);
+}
+
+void SolutionCache::Clear()
+{
+	for (auto& shard : m_shards) {
+		std::lock_guard<std::mutex> guard(shard->lock);
+		shard->index.clear();
+		shard->entries.clear();
+	}
+}
+
+size_t SolutionCache::GetEntryCount() const
+{
+	size_t count = 0;
+	for (auto& shard : m_shards) {
+		std::lock_guard<std::mutex> guard(shard->lock);
+		count += shard->entries.size();
+	}
+	return count;
+}
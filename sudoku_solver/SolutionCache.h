@@ -0,0 +1,107 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoard.h"
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+/**
+ * @class SolutionCache
+ * @brief Bounded LRU cache of solved boards, keyed by the given layout
+ *
+ * Entries are keyed by a 64-bit hash of the 81 character layout (as written
+ * by `SudokuSolver::GetBoardAsStringLayout(board, char*)`). The full layout is
+ * stored with each entry, so hash collisions are treated as misses rather than
+ * returning the wrong solution. Layouts and solutions are copied in and out as
+ * plain characters, so a lookup allocates nothing.
+ *
+ * The cache is split into independently locked shards, so that lookups from
+ * multiple solver threads rarely contend.
+ */
+class SolutionCache
+{
+public:
+
+    /**
+     * @brief Constructs the cache
+     * @param memory_budget Approximate upper limit of memory used by the entries, in bytes
+     * @param shard_count Number of independently locked partitions
+     */
+    explicit SolutionCache(size_t memory_budget = 16 * 1024 * 1024, int shard_count = 16);
+
+    /**
+     * @brief Finds a previous result for the given layout
+     * @param layout The unsolved board layout, 81 characters
+     * @param solution Receives the 81 characters of the solved layout. Only
+     *                 written if the board was solved.
+     * @param steps Receives the number of steps the original solve took
+     * @param solved Receives whether the original solve succeeded
+     * @return True if the layout was found, false otherwise
+     */
+    bool Lookup(const char* layout, char* solution, int& steps, bool& solved);
+
+    /**
+     * @brief Stores a result, evicting the least recently used entries if over budget
+     * @param layout The unsolved board layout, 81 characters
+     * @param solution The 81 characters of the solved layout, or nullptr if the
+     *                 board could not be solved
+     * @param steps The number of steps taken
+     * @param solved Whether the solve succeeded
+     */
+    void Insert(const char* layout, const char* solution, int steps, bool solved);
+
+    /**
+     * @brief Removes all entries. Counters are not reset.
+     */
+    void Clear();
+
+    /**
+     * @brief Returns the 64-bit key used for the given layout
+     */
+    static uint64_t HashLayout(const char* layout);
+
+    uint64_t GetHits() const { return m_hits.load(std::memory_order_relaxed); }
+    uint64_t GetMisses() const { return m_misses.load(std::memory_order_relaxed); }
+    uint64_t GetEvictions() const { return m_evictions.load(std::memory_order_relaxed); }
+    size_t GetEntryCount() const;
+    size_t GetCapacity() const { return m_capacityPerShard * m_shards.size(); }
+
+    /**
+     * @brief Approximate memory used by a single entry, including container overhead
+     */
+    static size_t GetEntrySize();
+
+protected:
+
+    struct Entry {
+        uint64_t key;
+        char layout[BOARD_SIZE * BOARD_SIZE];
+        char solution[BOARD_SIZE * BOARD_SIZE];
+        int steps;
+        bool solved;
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::list<Entry> entries;       // most recently used at the front
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    };
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    size_t m_capacityPerShard;
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_evictions{ 0 };
+
+    Shard& GetShard(uint64_t key) { return *m_shards[(key >> 32) % m_shards.size()]; }
+};
@@ -0,0 +1,296 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SolutionEnumerator.h"
+#include <thread>
+
+namespace {
+
+	constexpr uint32_t CHECKPOINT_CLOCK_NODES = 4096;	// nodes between looks at the clock
+	constexpr size_t TASKS_PER_THREAD = 16;				// subtrees to split into, per thread
+
+	int64_t GetClockTicks()
+	{
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+	}
+}
+
+SolutionEnumerator::SolutionEnumerator(int thread_count /*= 1*/)
+{
+	if (thread_count <= 0)
+		thread_count = static_cast<int>(std::thread::hardware_concurrency());
+	m_threadCount = (thread_count > 0) ? thread_count : 1;
+}
+
+void SolutionEnumerator::SetCheckpoint(const CheckpointCallback& callback, double interval_seconds)
+{
+	m_onCheckpoint = callback;
+	m_checkpointInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval_seconds));
+}
+
+void SolutionEnumerator::Report(const SUnitMasks& state)
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	if (m_stop.load(std::memory_order_relaxed))
+		return;
+
+	m_found++;
+	if (!(*m_callback)(state.values) || (m_limit && (m_found >= m_limit)))
+		m_stop = true;
+}
+
+/*
+* Depth first, always branching on the free cell with the fewest candidates.
+* The path is kept in the walker, so that a checkpoint can be taken at the
+* start of any node.
+*/
+void SolutionEnumerator::Search(Walker& walker)
+{
+	if (m_stop.load(std::memory_order_relaxed))
+		return;
+
+	if (m_onCheckpoint) {
+		if (((++walker.nodes % CHECKPOINT_CLOCK_NODES) == 0) && (GetClockTicks() >= m_nextCheckpoint.load(std::memory_order_relaxed))) {
+			TakeCheckpoint();
+		}
+		else if (m_pauseRequested.load(std::memory_order_relaxed)) {
+			Pause();
+		}
+
+		if (m_stop.load(std::memory_order_relaxed))
+			return;
+	}
+
+	SUnitMasks& state = walker.state;
+	uint16_t candidates;
+	int cell = state.FindBranchCell(candidates);
+	if (cell < 0) {
+		Report(state);
+		return;
+	}
+
+	int level = walker.depth++;
+	walker.cells[level] = static_cast<uint8_t>(cell);
+
+	for (uint16_t mask = candidates; mask; ) {
+		uint16_t bit = mask & (0 - mask);
+		mask &= (mask - 1);
+		walker.untried[level] = mask;
+
+		state.Place(cell, bit);
+		Search(walker);
+		state.Remove(cell);
+
+		if (m_stop.load(std::memory_order_relaxed))
+			break;
+	}
+	walker.depth--;
+}
+
+/*
+* Expands the top levels of the tree breadth first, until there are enough
+* subtrees to keep the threads busy. Children replace their parent in place,
+* so the subtrees stay in the order a single thread would search them.
+*/
+void SolutionEnumerator::Split(std::vector<SUnitMasks>& tasks)
+{
+	std::vector<SUnitMasks> next;
+	size_t wanted = static_cast<size_t>(m_threadCount) * TASKS_PER_THREAD;
+
+	for (int depth = 0; (depth < m_splitDepth) && (tasks.size() < wanted); depth++) {
+		next.clear();
+		for (const auto& state : tasks) {
+			uint16_t candidates;
+			int cell = state.FindBranchCell(candidates);
+			if (cell < 0) {
+				next.push_back(state);
+				continue;
+			}
+
+			for (uint16_t mask = candidates; mask; mask &= (mask - 1)) {
+				SUnitMasks child = state;
+				child.Place(cell, mask & (0 - mask));
+				next.push_back(child);
+			}
+		}
+		tasks.swap(next);
+	}
+}
+
+/*
+* Waits for every other thread to pause, then hands the frontier to the
+* callback. The current node of each paused walker has not been searched yet,
+* so it heads that walker's part of the frontier.
+*/
+void SolutionEnumerator::TakeCheckpoint()
+{
+	std::unique_lock<std::mutex> lock(m_pauseLock);
+	if (m_pauseRequested.load(std::memory_order_relaxed)) {
+		lock.unlock();
+		Pause();
+		return;
+	}
+
+	m_pauseRequested = true;
+	m_paused++;
+	m_pauseChanged.wait(lock, [this] { return m_paused == m_running; });
+
+	SEnumerationCheckpoint checkpoint;
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		checkpoint.found = m_found;
+	}
+
+	for (const auto* walker : m_walkers) {
+		if (!walker->is_done)
+			AddFrontier(*walker, checkpoint.frontier);
+	}
+
+	std::string layout(SBoardTables::CellCount, '0');
+	for (size_t i = m_nextTask.load(); i < m_tasks.size(); i++) {
+		for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+			layout[cell] = static_cast<char>('0' + m_tasks[i].values[cell]);
+		}
+		checkpoint.frontier.push_back(layout);
+	}
+
+	if (!m_stop.load() && !m_onCheckpoint(checkpoint))
+		m_stop = true;
+
+	m_nextCheckpoint = GetClockTicks() + m_checkpointInterval.count();
+	m_paused = 0;
+	m_pauseRequested = false;
+	m_pauseCount++;
+	m_pauseChanged.notify_all();
+}
+
+void SolutionEnumerator::Pause()
+{
+	std::unique_lock<std::mutex> lock(m_pauseLock);
+	if (!m_pauseRequested.load(std::memory_order_relaxed))
+		return;
+
+	auto pause_count = m_pauseCount;
+	m_paused++;
+	m_pauseChanged.notify_all();
+	m_pauseChanged.wait(lock, [this, pause_count] { return m_pauseCount != pause_count; });
+}
+
+/*
+* The current node first, then the untried siblings of each level of the
+* path, deepest first. This is the order the walker would have gone on in.
+*/
+void SolutionEnumerator::AddFrontier(const Walker& walker, std::vector<std::string>& frontier)
+{
+	std::string layout(SBoardTables::CellCount, '0');
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		layout[cell] = static_cast<char>('0' + walker.state.values[cell]);
+	}
+	frontier.push_back(layout);
+
+	for (int level = walker.depth - 1; level >= 0; level--) {
+		int cell = walker.cells[level];
+		for (uint16_t mask = walker.untried[level]; mask; mask &= (mask - 1)) {
+			layout[cell] = static_cast<char>('1' + LowestDigit(mask));
+			frontier.push_back(layout);
+		}
+		layout[cell] = '0';
+	}
+}
+
+void SolutionEnumerator::RunWorker(Walker& walker)
+{
+	size_t index;
+	while (!m_stop.load(std::memory_order_relaxed) && ((index = m_nextTask++) < m_tasks.size())) {
+		walker.state = m_tasks[index];
+		walker.depth = 0;
+		Search(walker);
+	}
+
+	// A checkpoint in progress may be waiting for this thread.
+	std::lock_guard<std::mutex> lock(m_pauseLock);
+	walker.is_done = true;
+	m_running--;
+	m_pauseChanged.notify_all();
+}
+
+uint64_t SolutionEnumerator::Run(uint64_t found, const Callback& callback, uint64_t limit)
+{
+	m_callback = &callback;
+	m_limit = limit;
+	m_found = found;
+	m_stop = (limit != 0) && (found >= limit);
+	m_nextTask = 0;
+	m_pauseRequested = false;
+	m_paused = 0;
+	m_nextCheckpoint = GetClockTicks() + m_checkpointInterval.count();
+
+	if (m_threadCount > 1)
+		Split(m_tasks);
+
+	std::vector<Walker> walkers(static_cast<size_t>(m_threadCount));
+	m_walkers.clear();
+	for (auto& walker : walkers) {
+		m_walkers.push_back(&walker);
+	}
+	m_running = m_threadCount;
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < m_threadCount; i++) {
+		threads.emplace_back(&SolutionEnumerator::RunWorker, this, std::ref(walkers[i]));
+	}
+	RunWorker(walkers[0]);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	m_walkers.clear();
+	m_tasks.clear();
+	return m_found;
+}
+
+uint64_t SolutionEnumerator::Enumerate(const Grid& puzzle, const Callback& callback, uint64_t limit /*= 0*/)
+{
+	m_tasks.resize(1);
+	if (!m_tasks[0].Load(puzzle))
+		m_tasks.clear();
+
+	return Run(0, callback, limit);
+}
+
+uint64_t SolutionEnumerator::Enumerate(const SBoard& board, const Callback& callback, uint64_t limit /*= 0*/)
+{
+	Grid puzzle;
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		puzzle[cell] = static_cast<uint8_t>(board.GetCellDirect(cell).value);
+	}
+	return Enumerate(puzzle, callback, limit);
+}
+
+/*
+* Layouts in the frontier that are not partial boards have no solutions.
+*/
+uint64_t SolutionEnumerator::Resume(const SEnumerationCheckpoint& checkpoint, const Callback& callback, uint64_t limit /*= 0*/)
+{
+	m_tasks.clear();
+	m_tasks.reserve(checkpoint.frontier.size());
+
+	Grid values;
+	SUnitMasks state;
+	for (const auto& layout : checkpoint.frontier) {
+		if (layout.size() != SBoardTables::CellCount)
+			continue;
+
+		bool is_valid = true;
+		for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+			is_valid &= (layout[cell] >= '0') && (layout[cell] <= '9');
+			values[cell] = static_cast<uint8_t>(layout[cell] - '0');
+		}
+		if (is_valid && state.Load(values))
+			m_tasks.push_back(state);
+	}
+
+	return Run(checkpoint.found, callback, limit);
+}
@@ -0,0 +1,160 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoardTables.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief The progress of an enumeration, from which it can be resumed
+ *
+ * The frontier is the part of the search tree still to be explored, as
+ * partial boards (81 characters, '0' for empty cells). Every solution not yet
+ * found is a solution of exactly one of them.
+ *
+ * Only a checkpoint of a single threaded run lists them in the order that
+ * run would have searched them, so only then does a resumed run give the
+ * remaining solutions in the same order.
+ */
+struct SEnumerationCheckpoint
+{
+    uint64_t found = 0;                     // solutions passed to the callback so far
+    std::vector<std::string> frontier;      // the walkers' parts by thread, then the unstarted subtrees
+};
+
+/**
+ * @class SolutionEnumerator
+ * @brief Finds every solution of a board, handing each one over as it is found
+ *
+ * Nothing is kept per solution, so memory use is the same however many
+ * solutions there are. The top levels of the search tree are split into
+ * subtrees, which are shared out between the threads. With more than one
+ * thread, solutions arrive in no particular order.
+ *
+ * If a checkpoint callback is set, the threads are paused once per interval
+ * and the callback given the search frontier. If the checkpointed run used
+ * one thread, a single thread resumed from its checkpoint finds the remaining
+ * solutions in the same order as that run would have.
+ */
+class SolutionEnumerator
+{
+public:
+
+    using Grid = uint8_t[SBoardTables::CellCount];   // values 0 - 9 in row order, 0 for empty
+
+    /**
+     * @brief Receives each solution. Return false to stop the enumeration.
+     *
+     * Calls are never concurrent, even with several threads, so the callback
+     * needs no locking of its own.
+     */
+    using Callback = std::function<bool(const Grid& solution)>;
+
+    /**
+     * @brief Receives each checkpoint, while the search is paused. Return false to stop.
+     *
+     * Every solution found before the checkpoint has been passed to the
+     * solution callback by then.
+     */
+    using CheckpointCallback = std::function<bool(const SEnumerationCheckpoint& checkpoint)>;
+
+    /**
+     * @param thread_count Number of threads searching, 0 = one per core
+     */
+    explicit SolutionEnumerator(int thread_count = 1);
+
+    /**
+     * @brief Enumerates the solutions of the puzzle
+     * @param puzzle The puzzle. Clashing clues give no solutions.
+     * @param callback Receives each solution
+     * @param limit Stop after this many solutions, 0 = no limit
+     * @return The number of solutions passed to the callback
+     */
+    uint64_t Enumerate(const Grid& puzzle, const Callback& callback, uint64_t limit = 0);
+
+    /**
+     * @brief As above, from a board
+     */
+    uint64_t Enumerate(const SBoard& board, const Callback& callback, uint64_t limit = 0);
+
+    /**
+     * @brief Continues an enumeration from a checkpoint
+     * @param limit As above, including the solutions found before the checkpoint
+     * @return The number of solutions found in all, including those before the checkpoint
+     */
+    uint64_t Resume(const SEnumerationCheckpoint& checkpoint, const Callback& callback, uint64_t limit = 0);
+
+    /**
+     * @brief Sets the callback for checkpoints, or an empty one for none
+     */
+    void SetCheckpoint(const CheckpointCallback& callback, double interval_seconds);
+
+    /**
+     * @brief Sets how many levels of the search tree are split between the threads
+     */
+    void SetSplitDepth(int depth) { m_splitDepth = depth; }
+
+    int GetThreadCount() const { return m_threadCount; }
+
+protected:
+
+    // A thread's place in the search. Each level of the current path has
+    // the cell branched on, and the candidates not tried yet.
+    struct Walker {
+        SUnitMasks state;
+        int depth = 0;
+        uint8_t cells[SBoardTables::CellCount];
+        uint16_t untried[SBoardTables::CellCount];
+        uint32_t nodes = 0;
+        bool is_done = false;
+    };
+
+    int m_threadCount = 1;
+    int m_splitDepth = 3;
+
+    CheckpointCallback m_onCheckpoint;
+    std::chrono::steady_clock::duration m_checkpointInterval{};
+
+    // State of the enumeration in progress
+    const Callback* m_callback = nullptr;
+    uint64_t m_limit = 0;
+    uint64_t m_found = 0;               // guarded by m_lock
+    std::mutex m_lock;
+    std::atomic<bool> m_stop{ false };
+    std::vector<SUnitMasks> m_tasks;
+    std::atomic<size_t> m_nextTask{ 0 };
+
+    // Pausing the threads for a checkpoint, guarded by m_pauseLock
+    std::mutex m_pauseLock;
+    std::condition_variable m_pauseChanged;
+    std::atomic<bool> m_pauseRequested{ false };
+    std::vector<Walker*> m_walkers;
+    int m_running = 0;
+    int m_paused = 0;
+    uint64_t m_pauseCount = 0;
+    std::atomic<int64_t> m_nextCheckpoint{ 0 };     // steady clock ticks
+
+    uint64_t Run(uint64_t found, const Callback& callback, uint64_t limit);
+    void RunWorker(Walker& walker);
+    void Search(Walker& walker);
+    void Report(const SUnitMasks& state);
+    void Split(std::vector<SUnitMasks>& tasks);
+
+    void TakeCheckpoint();
+    void Pause();
+
+    /**
+     * @brief Appends the part of the walker's subtree still to be searched
+     */
+    static void AddFrontier(const Walker& walker, std::vector<std::string>& frontier);
+};
@@ -0,0 +1,209 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SolutionVerifier.h"
+#include "SBoardTables.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#include <emmintrin.h>
+#define VERIFIER_USE_SSE2
+#endif
+
+namespace {
+
+	constexpr unsigned int ALL_VALUES = (1u << BOARD_SIZE) - 1;
+
+	// Looked up rather than shifted, as variable shifts are slow on some CPUs.
+	constexpr uint16_t VALUE_BITS[BOARD_SIZE] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+
+	std::string_view Trim(std::string_view s)
+	{
+		auto first = s.find_first_not_of(" \t\r\n");
+		if (first == std::string_view::npos)
+			return {};
+		auto last = s.find_last_not_of(" \t\r\n");
+		return s.substr(first, last - first + 1);
+	}
+
+	/*
+	* Checks one cell. The digit (0 - 8) is stored for the unit check.
+	*/
+	SVerifyResult VerifyCell(char p, char s, uint8_t& digit)
+	{
+		unsigned int value = static_cast<unsigned char>(s) - static_cast<unsigned int>('1');
+		if (value >= BOARD_SIZE)
+			return SVerifyResult::BadCharacter;
+
+		unsigned int given = static_cast<unsigned char>(p) - static_cast<unsigned int>('1');
+		if ((given < BOARD_SIZE) && (given != value))
+			return SVerifyResult::GivenChanged;
+
+		digit = static_cast<uint8_t>(value);
+		return SVerifyResult::Valid;
+	}
+}
+
+bool SolutionVerifier::AreUnitsComplete(const uint8_t* digits)
+{
+	uint16_t bits[SBoardTables::CellCount];
+	for (int i = 0; i < SBoardTables::CellCount; i++) {
+		bits[i] = VALUE_BITS[digits[i]];
+	}
+
+	// With 9 cells to a unit, all 9 bits are only set if no value repeats.
+	// Rows and blocks are taken a band of 3 rows at a time, from the same
+	// triples of cells.
+	unsigned int all = ALL_VALUES;
+	for (int band = 0; band < BOARD_SIZE; band += 3) {
+		unsigned int block0 = 0, block1 = 0, block2 = 0;
+		for (int r = band; r < band + 3; r++) {
+			const uint16_t* row = bits + r * BOARD_SIZE;
+			unsigned int left = row[0] | row[1] | row[2];
+			unsigned int middle = row[3] | row[4] | row[5];
+			unsigned int right = row[6] | row[7] | row[8];
+			all &= left | middle | right;
+			block0 |= left;
+			block1 |= middle;
+			block2 |= right;
+		}
+		all &= block0 & block1 & block2;
+	}
+
+	for (int c = 0; c < BOARD_SIZE; c++) {
+		unsigned int col = 0;
+		for (int r = 0; r < BOARD_SIZE; r++) {
+			col |= bits[r * BOARD_SIZE + c];
+		}
+		all &= col;
+	}
+	return (all == ALL_VALUES);
+}
+
+SVerifyResult SolutionVerifier::VerifyScalar(const char* puzzle, const char* solution)
+{
+	uint8_t digits[SBoardTables::CellCount];
+	for (int i = 0; i < SBoardTables::CellCount; i++) {
+		auto result = VerifyCell(puzzle[i], solution[i], digits[i]);
+		if (result != SVerifyResult::Valid)
+			return result;
+	}
+	return AreUnitsComplete(digits) ? SVerifyResult::Valid : SVerifyResult::DuplicateValue;
+}
+
+SVerifyResult SolutionVerifier::Verify(const char* puzzle, const char* solution)
+{
+#ifdef VERIFIER_USE_SSE2
+	const __m128i one_char = _mm_set1_epi8('1');
+	const __m128i eight = _mm_set1_epi8(8);
+
+	// 5 blocks of 16 characters, then the last one on its own.
+	// NB: Bad characters are reported ahead of changed givens, as VerifyScalar().
+	alignas(16) uint8_t digits[SBoardTables::CellCount];
+	bool has_changed = false;
+	int i = 0;
+	for (; i + 16 <= SBoardTables::CellCount; i += 16) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(solution + i));
+		__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(puzzle + i));
+
+		// '1' - '9' become 0 - 8. Anything else becomes > 8 (as unsigned).
+		__m128i values = _mm_sub_epi8(s, one_char);
+		__m128i is_value = _mm_cmpeq_epi8(_mm_min_epu8(values, eight), values);
+		if (_mm_movemask_epi8(is_value) != 0xFFFF)
+			return SVerifyResult::BadCharacter;
+
+		__m128i givens = _mm_sub_epi8(p, one_char);
+		__m128i is_given = _mm_cmpeq_epi8(_mm_min_epu8(givens, eight), givens);
+		__m128i is_same = _mm_cmpeq_epi8(p, s);
+		has_changed = has_changed || (_mm_movemask_epi8(_mm_andnot_si128(is_same, is_given)) != 0);
+
+		_mm_store_si128(reinterpret_cast<__m128i*>(digits + i), values);
+	}
+
+	for (; i < SBoardTables::CellCount; i++) {
+		auto result = VerifyCell(puzzle[i], solution[i], digits[i]);
+		if (result == SVerifyResult::BadCharacter)
+			return result;
+		has_changed = has_changed || (result == SVerifyResult::GivenChanged);
+	}
+
+	if (has_changed)
+		return SVerifyResult::GivenChanged;
+
+	return AreUnitsComplete(digits) ? SVerifyResult::Valid : SVerifyResult::DuplicateValue;
+#else
+	return VerifyScalar(puzzle, solution);
+#endif
+}
+
+SVerifyResult SolutionVerifier::VerifyLine(std::string_view line)
+{
+	auto comma = line.find(',');
+	if (comma == std::string_view::npos)
+		return SVerifyResult::BadFormat;
+
+	auto puzzle = Trim(line.substr(0, comma));
+	auto next = line.find(',', comma + 1);
+	auto solution = Trim(line.substr(comma + 1, (next == std::string_view::npos) ? std::string_view::npos : next - comma - 1));
+	if ((puzzle.size() != SBoardTables::CellCount) || (solution.size() != SBoardTables::CellCount))
+		return SVerifyResult::BadFormat;
+
+	return Verify(puzzle.data(), solution.data());
+}
+
+const char* SolutionVerifier::GetResultName(SVerifyResult result)
+{
+	switch (result) {
+	case SVerifyResult::Valid: return "valid";
+	case SVerifyResult::BadFormat: return "bad format";
+	case SVerifyResult::BadCharacter: return "bad character";
+	case SVerifyResult::GivenChanged: return "given changed";
+	case SVerifyResult::DuplicateValue: return "duplicate value";
+	}
+	return "";
+}
+
+bool SolutionVerifier::Run(const std::string& input_path, SolutionWriter& report)
+{
+	LineReader reader;
+	return reader.Open(input_path) && Run(reader, report);
+}
+
+bool SolutionVerifier::Run(FILE* input, SolutionWriter& report)
+{
+	LineReader reader;
+	reader.Attach(input);
+	return Run(reader, report);
+}
+
+bool SolutionVerifier::Run(LineReader& reader, SolutionWriter& report)
+{
+	bool is_ok = true;
+	std::string_view line;
+	while (reader.ReadLine(line)) {
+		line = Trim(line);
+		if (line.empty())
+			continue;
+
+		m_stats.lines++;
+		auto result = VerifyLine(line);
+		if (result == SVerifyResult::Valid) {
+			m_stats.valid++;
+			continue;
+		}
+
+		if (result == SVerifyResult::BadFormat) {
+			m_stats.malformed++;
+		}
+		else {
+			m_stats.invalid++;
+		}
+
+		std::string entry = std::to_string(reader.GetLineNumber());
+		entry += ',';
+		entry += GetResultName(result);
+		is_ok &= report.WriteLine(entry);
+	}
+	return is_ok && !reader.HasFailed();
+}
@@ -0,0 +1,100 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SolutionWriter.h"
+#include "LineReader.h"
+#include <string>
+#include <string_view>
+#include <cstdio>
+#include <cstdint>
+
+/**
+ * @brief Outcome of verifying a solution against its puzzle
+ */
+enum class SVerifyResult {
+    Valid,
+    BadFormat,          // not two fields of 81 characters
+    BadCharacter,       // the solution has a character other than '1' - '9'
+    GivenChanged,       // a given of the puzzle differs in the solution
+    DuplicateValue      // a row, column or block is not a permutation of 1 - 9
+};
+
+/**
+ * @brief Counts kept by `SolutionVerifier`
+ */
+struct SVerifyStats
+{
+    uint64_t lines = 0;         // non blank input lines
+    uint64_t valid = 0;
+    uint64_t invalid = 0;       // a grid failed verification
+    uint64_t malformed = 0;     // not a `puzzle,solution` line (e.g. a header)
+};
+
+/**
+ * @class SolutionVerifier
+ * @brief Checks complete grids against their puzzles, without solving
+ *
+ * A solution is valid if it is 81 digits '1' - '9', keeps every given of the
+ * puzzle, and each row, column and block holds every value exactly once. The
+ * characters and givens are compared 16 at a time with SSE2 where available,
+ * and the units are checked with one bit mask each.
+ *
+ * Input lines are the `puzzle,solution` rows of the test data files. Any
+ * further fields are ignored.
+ */
+class SolutionVerifier
+{
+public:
+
+    /**
+     * @brief Verifies a solution against its puzzle
+     * @param puzzle 81 characters. '1' - '9' are givens, anything else is empty.
+     * @param solution 81 characters
+     */
+    static SVerifyResult Verify(const char* puzzle, const char* solution);
+
+    /**
+     * @brief Scalar version of the above, used where SSE2 is not available
+     */
+    static SVerifyResult VerifyScalar(const char* puzzle, const char* solution);
+
+    /**
+     * @brief Verifies a `puzzle,solution` line, without the line terminator
+     */
+    static SVerifyResult VerifyLine(std::string_view line);
+
+    static const char* GetResultName(SVerifyResult result);
+
+    /**
+     * @brief Verifies all the lines of the file
+     * @param report Receives a `line,result` line for each line that is not
+     *               valid. Line numbers count from 1.
+     * @return False if the file could not be read, or the report failed
+     */
+    bool Run(const std::string& input_path, SolutionWriter& report);
+
+    /**
+     * @brief As above, reading from an open stream (e.g. stdin)
+     */
+    bool Run(FILE* input, SolutionWriter& report);
+
+    /**
+     * @brief As above, reading the remaining lines of the reader
+     */
+    bool Run(LineReader& reader, SolutionWriter& report);
+
+    const SVerifyStats& GetStats() const { return m_stats; }
+
+protected:
+
+    /**
+     * @brief Checks every unit of a grid of values 0 - 8 is a permutation
+     */
+    static bool AreUnitsComplete(const uint8_t* digits);
+
+    SVerifyStats m_stats;
+};
@@ -0,0 +1,334 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SolutionWriter.h"
+#include "SBoardTables.h"
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SolutionWriter::SolutionWriter(size_t buffer_size /*= DEFAULT_BUFFER_SIZE*/)
+	: m_buffer(buffer_size < 2 * SBoardTables::CellCount + 2 ? 2 * SBoardTables::CellCount + 2 : buffer_size)
+{
+}
+
+SolutionWriter::~SolutionWriter()
+{
+	Close();
+}
+
+bool SolutionWriter::OpenStdout()
+{
+	Close();
+	m_total = 0;
+	m_writeCount = 0;
+	m_file = stdout;
+	m_ownsFile = false;
+	m_sink = Sink::Stream;
+	m_data = m_buffer.data();
+	m_capacity = m_buffer.size();
+	return true;
+}
+
+bool SolutionWriter::OpenFile(const std::string& path)
+{
+	Close();
+	m_total = 0;
+	m_writeCount = 0;
+	m_file = std::fopen(path.c_str(), "wb");
+	if (m_file == nullptr)
+		return false;
+
+	// Our own buffer is the only one needed.
+	std::setvbuf(m_file, nullptr, _IONBF, 0);
+	m_ownsFile = true;
+	m_sink = Sink::Stream;
+	m_data = m_buffer.data();
+	m_capacity = m_buffer.size();
+	return true;
+}
+
+bool SolutionWriter::ResumeFile(const std::string& path, uint64_t size)
+{
+	Close();
+	m_total = 0;
+	m_writeCount = 0;
+
+	// The file can only be cut back, never extended.
+	std::error_code ec;
+	auto file_size = std::filesystem::file_size(path, ec);
+	if (ec || (file_size < size))
+		return false;
+
+	std::filesystem::resize_file(path, size, ec);
+	if (ec)
+		return false;
+
+	m_file = std::fopen(path.c_str(), "ab");
+	if (m_file == nullptr)
+		return false;
+
+	std::setvbuf(m_file, nullptr, _IONBF, 0);
+	m_total = size;
+	m_ownsFile = true;
+	m_sink = Sink::Stream;
+	m_data = m_buffer.data();
+	m_capacity = m_buffer.size();
+	return true;
+}
+
+bool SolutionWriter::Flush()
+{
+	if ((m_sink != Sink::Stream) || (m_used == 0))
+		return !m_hasFailed;
+
+	if (std::fwrite(m_data, 1, m_used, m_file) != m_used)
+		m_hasFailed = true;
+	if (!m_ownsFile)
+		std::fflush(m_file);
+
+	m_writeCount++;
+	m_total += m_used;
+	m_used = 0;
+	return !m_hasFailed;
+}
+
+char* SolutionWriter::Reserve(size_t length)
+{
+	if (m_data == nullptr)
+		return nullptr;
+
+	if (m_used + length > m_capacity) {
+		if (m_sink == Sink::Stream) {
+			Flush();
+		}
+		else {
+			size_t size = m_capacity * 2;
+			while (m_used + length > size)
+				size *= 2;
+
+			// The written size is kept if this fails, so Close() still trims
+			// the file to it.
+			UnmapFile();
+			if (!MapFile(size)) {
+				m_hasFailed = true;
+				return nullptr;
+			}
+		}
+	}
+	return m_data + m_used;
+}
+
+bool SolutionWriter::Write(std::string_view puzzle, const char* solution)
+{
+	size_t length = SBoardTables::CellCount + 1;
+	if (m_format == SOutputFormat::PuzzleAndSolution)
+		length += puzzle.size() + 1;
+
+	// Only an overlong (invalid) puzzle can fail to fit in the buffer.
+	if ((m_sink == Sink::Stream) && (length > m_capacity)) {
+		std::string line(puzzle);
+		line += ',';
+		if (solution != nullptr)
+			line.append(solution, SBoardTables::CellCount);
+		return WriteLine(line);
+	}
+
+	char* dest = Reserve(length);
+	if (dest == nullptr)
+		return false;
+
+	char* start = dest;
+	if (m_format == SOutputFormat::PuzzleAndSolution) {
+		std::memcpy(dest, puzzle.data(), puzzle.size());
+		dest += puzzle.size();
+		*dest++ = ',';
+	}
+	if (solution != nullptr) {
+		std::memcpy(dest, solution, SBoardTables::CellCount);
+		dest += SBoardTables::CellCount;
+	}
+	*dest++ = '\n';
+
+	m_used += static_cast<size_t>(dest - start);
+	return true;
+}
+
+bool SolutionWriter::WriteLine(std::string_view line)
+{
+	// A line longer than the whole buffer is written straight out.
+	if ((m_sink == Sink::Stream) && (line.size() + 1 > m_capacity)) {
+		Flush();
+		if ((std::fwrite(line.data(), 1, line.size(), m_file) != line.size()) || (std::fputc('\n', m_file) == EOF))
+			m_hasFailed = true;
+		m_writeCount++;
+		m_total += line.size() + 1;
+		return !m_hasFailed;
+	}
+
+	char* dest = Reserve(line.size() + 1);
+	if (dest == nullptr)
+		return false;
+
+	std::memcpy(dest, line.data(), line.size());
+	dest[line.size()] = '\n';
+	m_used += line.size() + 1;
+	return true;
+}
+
+bool SolutionWriter::Close()
+{
+	bool is_ok = !m_hasFailed;
+	if (m_sink == Sink::Stream) {
+		is_ok = Flush();
+		if (m_ownsFile && (std::fclose(m_file) != 0))
+			is_ok = false;
+	}
+	else if (m_sink == Sink::Mapped) {
+		// Trim the file to what has been written.
+		uint64_t size = m_used;
+		UnmapFile();
+
+#ifdef _WIN32
+		HANDLE file = reinterpret_cast<HANDLE>(m_fileHandle);
+		LARGE_INTEGER end;
+		end.QuadPart = static_cast<LONGLONG>(size);
+		if (!::SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !::SetEndOfFile(file))
+			is_ok = false;
+		::CloseHandle(file);
+#else
+		if (ftruncate(static_cast<int>(m_fileHandle), static_cast<off_t>(size)) != 0)
+			is_ok = false;
+		close(static_cast<int>(m_fileHandle));
+#endif
+		m_total = size;
+	}
+
+	m_sink = Sink::None;
+	m_file = nullptr;
+	m_ownsFile = false;
+	m_fileHandle = -1;
+	m_data = nullptr;
+	m_capacity = 0;
+	m_used = 0;
+	m_hasFailed = false;
+	return is_ok;
+}
+
+#ifdef _WIN32
+
+bool SolutionWriter::OpenMapped(const std::string& path, size_t initial_size)
+{
+	Close();
+	m_total = 0;
+	m_writeCount = 0;
+
+	HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_fileHandle = reinterpret_cast<intptr_t>(file);
+	m_sink = Sink::Mapped;
+	if (!MapFile(initial_size ? initial_size : m_buffer.size())) {
+		::CloseHandle(file);
+		m_fileHandle = -1;
+		m_sink = Sink::None;
+		return false;
+	}
+	return true;
+}
+
+/*
+* Maps the file at the given size, which also extends it.
+*/
+bool SolutionWriter::MapFile(size_t size)
+{
+	HANDLE mapping = ::CreateFileMappingA(reinterpret_cast<HANDLE>(m_fileHandle), nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), nullptr);
+	if (mapping == nullptr)
+		return false;
+
+	void* view = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (view == nullptr) {
+		::CloseHandle(mapping);
+		return false;
+	}
+
+	m_mapping = mapping;
+	m_data = static_cast<char*>(view);
+	m_capacity = size;
+	return true;
+}
+
+void SolutionWriter::UnmapFile()
+{
+	if (m_data != nullptr) {
+		::UnmapViewOfFile(m_data);
+		::CloseHandle(static_cast<HANDLE>(m_mapping));
+	}
+	m_mapping = nullptr;
+	m_data = nullptr;
+	m_capacity = 0;
+}
+
+#else
+
+bool SolutionWriter::OpenMapped(const std::string& path, size_t initial_size)
+{
+	Close();
+	m_total = 0;
+	m_writeCount = 0;
+
+	int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return false;
+
+	m_fileHandle = fd;
+	m_sink = Sink::Mapped;
+	if (!MapFile(initial_size ? initial_size : m_buffer.size())) {
+		close(fd);
+		m_fileHandle = -1;
+		m_sink = Sink::None;
+		return false;
+	}
+	return true;
+}
+
+/*
+* Extends the file to the given size, and maps all of it.
+*/
+bool SolutionWriter::MapFile(size_t size)
+{
+	int fd = static_cast<int>(m_fileHandle);
+	if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+		return false;
+
+	void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (view == MAP_FAILED)
+		return false;
+
+	m_data = static_cast<char*>(view);
+	m_capacity = size;
+	return true;
+}
+
+void SolutionWriter::UnmapFile()
+{
+	if (m_data != nullptr)
+		munmap(m_data, m_capacity);
+	m_data = nullptr;
+	m_capacity = 0;
+}
+
+#endif
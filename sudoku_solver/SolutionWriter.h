@@ -0,0 +1,125 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+/**
+ * @brief Line format of `SolutionWriter::Write()`
+ */
+enum class SOutputFormat {
+    Solution,               // <solution>
+    PuzzleAndSolution       // <puzzle>,<solution>
+};
+
+/**
+ * @class SolutionWriter
+ * @brief Buffered bulk output of solution lines
+ *
+ * Lines are appended into one large, reused buffer, and written out with a
+ * single write once the buffer is full (1 MB by default). Nothing is flushed
+ * per line.
+ *
+ * The output can be stdout, a file, or a memory mapped file. A mapped file is
+ * pre-sized, and lines are written straight into the mapping, which grows as
+ * needed. The file is trimmed to the written size when closed.
+ */
+class SolutionWriter
+{
+public:
+
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+    explicit SolutionWriter(size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    ~SolutionWriter();
+
+    SolutionWriter(const SolutionWriter&) = delete;
+    SolutionWriter& operator=(const SolutionWriter&) = delete;
+
+    bool OpenStdout();
+    bool OpenFile(const std::string& path);
+
+    /**
+     * @brief Continues an earlier output file, for a resumed run
+     * @param size The size written when the run was checkpointed. Anything
+     *             after it is cut off, and the new lines follow on from it.
+     */
+    bool ResumeFile(const std::string& path, uint64_t size);
+
+    /**
+     * @brief Creates (or replaces) a file and maps it for writing
+     * @param initial_size The size to map to start with. Doubled whenever full.
+     */
+    bool OpenMapped(const std::string& path, size_t initial_size);
+
+    /**
+     * @brief Writes out anything buffered, and closes the output
+     * @return False if any write failed
+     */
+    bool Close();
+
+    void SetFormat(SOutputFormat format) { m_format = format; }
+
+    /**
+     * @brief Appends a line in the current format
+     * @param puzzle The puzzle as read (only used by `PuzzleAndSolution`)
+     * @param solution 81 layout characters, or nullptr to leave the solution empty
+     */
+    bool Write(std::string_view puzzle, const char* solution);
+
+    /**
+     * @brief Appends a line as is. The line terminator is added.
+     */
+    bool WriteLine(std::string_view line);
+
+    /**
+     * @brief Writes out anything buffered (stdout and file only)
+     */
+    bool Flush();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    uint64_t GetBytesWritten() const { return m_total + m_used; }
+    uint64_t GetWriteCount() const { return m_writeCount; }
+
+protected:
+
+    enum class Sink { None, Stream, Mapped };
+
+    Sink m_sink = Sink::None;
+    SOutputFormat m_format = SOutputFormat::Solution;
+    bool m_hasFailed = false;
+
+    // Lines are appended to m_data, which is either m_buffer or the mapping.
+    char* m_data = nullptr;
+    size_t m_capacity = 0;
+    size_t m_used = 0;              // also the written size of a mapping, kept across remaps
+    uint64_t m_total = 0;           // bytes already written out of m_buffer
+    uint64_t m_writeCount = 0;
+
+    std::vector<char> m_buffer;
+    FILE* m_file = nullptr;
+    bool m_ownsFile = false;
+
+    intptr_t m_fileHandle = -1;     // mapped file, fd or HANDLE
+    void* m_mapping = nullptr;      // file mapping object (Windows)
+
+    /**
+     * @brief Makes room for `length` more bytes
+     * @return The address to append at, or nullptr on failure
+     */
+    char* Reserve(size_t length);
+
+    bool MapFile(size_t size);
+
+    /**
+     * @brief Unmaps the file, leaving `m_used` as the size written to it
+     */
+    void UnmapFile();
+};
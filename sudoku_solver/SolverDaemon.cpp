@@ -0,0 +1,478 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SolverDaemon.h"
+#include <algorithm>
+#include <filesystem>
+#include <cstring>
+#include <chrono>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+	using socket_t = SOCKET;
+	const intptr_t NO_SOCKET = static_cast<intptr_t>(INVALID_SOCKET);
+	constexpr int SEND_FLAGS = 0;
+
+	bool InitialiseSockets()
+	{
+		static const bool is_initialised = [] {
+			WSADATA data;
+			return (WSAStartup(MAKEWORD(2, 2), &data) == 0);
+		}();
+		return is_initialised;
+	}
+
+	void CloseSocket(intptr_t s) { closesocket(static_cast<socket_t>(s)); }
+	void ShutdownSocket(intptr_t s) { shutdown(static_cast<socket_t>(s), SD_BOTH); }
+#else
+	using socket_t = int;
+	const intptr_t NO_SOCKET = -1;
+	constexpr int SEND_FLAGS = MSG_NOSIGNAL;	// report closed peers as errors, not SIGPIPE
+
+	bool InitialiseSockets() { return true; }
+	void CloseSocket(intptr_t s) { close(static_cast<socket_t>(s)); }
+	void ShutdownSocket(intptr_t s) { shutdown(static_cast<socket_t>(s), SHUT_RDWR); }
+#endif
+
+	constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+	constexpr auto ACCEPT_RETRY_DELAY = std::chrono::milliseconds(10);	// after a failed accept(), e.g. out of descriptors
+
+	bool MakeAddress(const std::string& path, sockaddr_un& address)
+	{
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.empty() || (path.size() >= sizeof(address.sun_path)))
+			return false;
+
+		std::memcpy(address.sun_path, path.c_str(), path.size());
+		return true;
+	}
+
+	bool SendAll(intptr_t s, const char* data, size_t size)
+	{
+		while (size > 0) {
+			int chunk = static_cast<int>(std::min<size_t>(size, READ_CHUNK_SIZE));
+			int sent = send(static_cast<socket_t>(s), data, chunk, SEND_FLAGS);
+			if (sent <= 0)
+				return false;
+			data += sent;
+			size -= sent;
+		}
+		return true;
+	}
+
+	int Receive(intptr_t s, char* buffer, size_t size)
+	{
+		return recv(static_cast<socket_t>(s), buffer, static_cast<int>(size), 0);
+	}
+}
+
+/*****************************************************************************
+* SolverDaemon
+******************************************************************************/
+
+SolverDaemon::Connection::~Connection()
+{
+	CloseSocket(socket);
+}
+
+SolverDaemon::SolverDaemon(const SDaemonOptions& options)
+	: m_options(options), m_listener(NO_SOCKET)
+{
+	m_options.batch_size = std::max(m_options.batch_size, 1);
+	m_options.queue_capacity = std::max(m_options.queue_capacity, 1);
+	if (m_options.worker_count <= 0)
+		m_options.worker_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+SolverDaemon::~SolverDaemon()
+{
+	Stop();
+}
+
+bool SolverDaemon::Start()
+{
+	sockaddr_un address;
+	if (!InitialiseSockets() || !MakeAddress(m_options.socket_path, address))
+		return false;
+
+	// A socket file left behind by a previous run would make bind() fail.
+	std::error_code ec;
+	std::filesystem::remove(m_options.socket_path, ec);
+
+	m_listener = static_cast<intptr_t>(socket(AF_UNIX, SOCK_STREAM, 0));
+	if (m_listener == NO_SOCKET)
+		return false;
+
+	if ((bind(static_cast<socket_t>(m_listener), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) ||
+		(listen(static_cast<socket_t>(m_listener), SOMAXCONN) != 0)) {
+		CloseSocket(m_listener);
+		m_listener = NO_SOCKET;
+		return false;
+	}
+
+	if (m_options.cache_budget > 0)
+		m_cache = std::make_unique<SolutionCache>(m_options.cache_budget);
+
+	for (int i = 0; i < m_options.worker_count; i++) {
+		m_workers.emplace_back(&SolverDaemon::SolveBatches, this);
+	}
+	m_acceptor = std::thread(&SolverDaemon::AcceptConnections, this);
+	return true;
+}
+
+void SolverDaemon::Stop()
+{
+	if (m_stopping.exchange(true))
+		return;
+
+	// Wake up workers and readers waiting on the queue. The lock is taken so
+	// that none is between checking the flag and waiting, and misses this.
+	{
+		std::lock_guard<std::mutex> guard(m_queueLock);
+	}
+	m_queueNotFull.notify_all();
+	m_queueNotEmpty.notify_all();
+
+	// Wake up accept()
+	if (m_listener != NO_SOCKET) {
+		ShutdownSocket(m_listener);
+		CloseSocket(m_listener);
+	}
+	if (m_acceptor.joinable())
+		m_acceptor.join();
+
+	// Wake up readers waiting on the socket, and the writers.
+	{
+		std::lock_guard<std::mutex> guard(m_connectionsLock);
+		for (auto& connection : m_connections) {
+			{
+				std::lock_guard<std::mutex> connection_guard(connection->lock);
+				connection->closed = true;
+			}
+			connection->wake.notify_all();
+			ShutdownSocket(connection->socket);
+		}
+	}
+	for (auto& connection : m_connections) {
+		if (connection->reader.joinable())
+			connection->reader.join();
+		if (connection->writer.joinable())
+			connection->writer.join();
+	}
+	m_connections.clear();
+
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+	m_workers.clear();
+
+	if (m_listener != NO_SOCKET) {
+		std::error_code ec;
+		std::filesystem::remove(m_options.socket_path, ec);
+		m_listener = NO_SOCKET;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_stateLock);
+		m_stopped = true;
+	}
+	m_stateChanged.notify_all();
+}
+
+void SolverDaemon::Wait()
+{
+	std::unique_lock<std::mutex> guard(m_stateLock);
+	m_stateChanged.wait(guard, [this] { return m_stopped; });
+}
+
+void SolverDaemon::AcceptConnections()
+{
+	while (!m_stopping) {
+		auto s = static_cast<intptr_t>(accept(static_cast<socket_t>(m_listener), nullptr, nullptr));
+		if (s == NO_SOCKET) {
+			std::this_thread::sleep_for(ACCEPT_RETRY_DELAY);
+			continue;
+		}
+
+		if (m_stopping) {
+			CloseSocket(s);
+			break;
+		}
+
+		auto connection = std::make_shared<Connection>();
+		connection->socket = s;
+
+		std::lock_guard<std::mutex> guard(m_connectionsLock);
+
+		// Tidy up connections that have finished. Both threads of these are
+		// done, or about to be, so the joins do not wait.
+		for (auto it = m_connections.begin(); it != m_connections.end(); ) {
+			bool is_finished;
+			{
+				std::lock_guard<std::mutex> connection_guard((*it)->lock);
+				is_finished = (*it)->closed && (*it)->input_closed;
+			}
+			if (is_finished) {
+				(*it)->reader.join();
+				(*it)->writer.join();
+				it = m_connections.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+
+		m_connections.push_back(connection);
+		connection->reader = std::thread(&SolverDaemon::ReadRequests, this, connection);
+		connection->writer = std::thread(&SolverDaemon::WriteResponses, this, connection);
+	}
+}
+
+void SolverDaemon::ReadRequests(std::shared_ptr<Connection> connection)
+{
+	std::string buffer;
+	std::vector<char> chunk(READ_CHUNK_SIZE);
+	bool is_reading = true;
+
+	auto submit = [&](const std::string& line) {
+		Job job;
+		if (!SolverService::ParseRequest(line, job.request))
+			return true;
+
+		{
+			std::lock_guard<std::mutex> guard(connection->lock);
+			job.sequence = connection->received++;
+		}
+		if (job.request.id.empty())
+			job.request.id = std::to_string(job.sequence + 1);
+
+		job.connection = connection;
+		return Enqueue(std::move(job));
+	};
+
+	while (is_reading) {
+		int received = Receive(connection->socket, chunk.data(), chunk.size());
+		if (received <= 0) {
+			// Treat an unterminated last line as a request.
+			if (!buffer.empty())
+				submit(buffer);
+			break;
+		}
+
+		buffer.append(chunk.data(), received);
+
+		size_t start = 0;
+		size_t eol;
+		while (is_reading && ((eol = buffer.find('\n', start)) != std::string::npos)) {
+			is_reading = submit(buffer.substr(start, eol - start));
+			start = eol + 1;
+		}
+		buffer.erase(0, start);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(connection->lock);
+		connection->input_closed = true;
+	}
+	connection->wake.notify_one();
+}
+
+/*
+* Writes the responses passed on by `Deliver()`, outside the connection lock,
+* so that a client that is not reading blocks only this thread. The
+* connection is closed once every request read has been answered.
+*/
+void SolverDaemon::WriteResponses(std::shared_ptr<Connection> connection)
+{
+	std::string out;
+	std::unique_lock<std::mutex> guard(connection->lock);
+	while (true) {
+		connection->wake.wait(guard, [&connection] {
+			return connection->closed || !connection->outbox.empty() || (connection->input_closed && (connection->sent == connection->received));
+		});
+		if (connection->closed)
+			break;
+
+		if (connection->outbox.empty()) {
+			connection->closed = true;
+			ShutdownSocket(connection->socket);
+			break;
+		}
+
+		out.swap(connection->outbox);
+		guard.unlock();
+		bool is_sent = SendAll(connection->socket, out.data(), out.size());
+		out.clear();
+		guard.lock();
+
+		if (!is_sent) {
+			// The client has gone. Stop its reader, and drop any further responses.
+			connection->closed = true;
+			ShutdownSocket(connection->socket);
+			break;
+		}
+	}
+}
+
+/*
+* Blocks while the queue is full. The reader therefore stops draining its
+* socket, and the client is held back by the socket buffers.
+*/
+bool SolverDaemon::Enqueue(Job&& job)
+{
+	std::unique_lock<std::mutex> guard(m_queueLock);
+	m_queueNotFull.wait(guard, [this] { return m_stopping || (m_queue.size() < static_cast<size_t>(m_options.queue_capacity)); });
+	if (m_stopping)
+		return false;
+
+	m_queue.push_back(std::move(job));
+	guard.unlock();
+	m_queueNotEmpty.notify_one();
+	return true;
+}
+
+void SolverDaemon::SolveBatches()
+{
+	SolverService service;
+	service.SetSolutionCache(m_cache.get());
+	service.SetLimits(m_options.limits);
+
+	std::vector<Job> batch;
+	batch.reserve(m_options.batch_size);
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(m_queueLock);
+			m_queueNotEmpty.wait(guard, [this] { return m_stopping || !m_queue.empty(); });
+			if (m_stopping)
+				return;
+
+			while (!m_queue.empty() && (batch.size() < static_cast<size_t>(m_options.batch_size))) {
+				batch.push_back(std::move(m_queue.front()));
+				m_queue.pop_front();
+			}
+		}
+		m_queueNotFull.notify_all();
+		m_batchCount++;
+
+		for (auto& job : batch) {
+			auto response = service.SolveRequest(job.request);
+			m_requestCount++;
+			Deliver(*job.connection, job.sequence, std::move(response));
+		}
+		batch.clear();
+	}
+}
+
+/*
+* Responses are held back until all earlier responses of the connection have
+* been passed to its writer, so the client always sees them in request order.
+* Nothing here blocks on the socket.
+*/
+void SolverDaemon::Deliver(Connection& connection, uint64_t sequence, std::string&& response)
+{
+	{
+		std::lock_guard<std::mutex> guard(connection.lock);
+		if (connection.closed)
+			return;
+
+		connection.completed.emplace(sequence, std::move(response));
+
+		auto it = connection.completed.find(connection.sent);
+		if (it == connection.completed.end())
+			return;
+
+		for (; it != connection.completed.end(); it = connection.completed.find(connection.sent)) {
+			connection.outbox += it->second;
+			connection.outbox += '\n';
+			connection.completed.erase(it);
+			connection.sent++;
+		}
+	}
+	connection.wake.notify_one();
+}
+
+/*****************************************************************************
+* SolverClient
+******************************************************************************/
+
+SolverClient::SolverClient()
+	: m_socket(NO_SOCKET)
+{
+}
+
+SolverClient::~SolverClient()
+{
+	Close();
+}
+
+bool SolverClient::Connect(const std::string& socket_path)
+{
+	Close();
+
+	sockaddr_un address;
+	if (!InitialiseSockets() || !MakeAddress(socket_path, address))
+		return false;
+
+	m_socket = static_cast<intptr_t>(socket(AF_UNIX, SOCK_STREAM, 0));
+	if (m_socket == NO_SOCKET)
+		return false;
+
+	if (connect(static_cast<socket_t>(m_socket), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void SolverClient::Close()
+{
+	if (m_socket != NO_SOCKET) {
+		CloseSocket(m_socket);
+		m_socket = NO_SOCKET;
+	}
+	m_buffer.clear();
+}
+
+bool SolverClient::Send(const std::string& line)
+{
+	if (m_socket == NO_SOCKET)
+		return false;
+
+	std::string data = line + '\n';
+	return SendAll(m_socket, data.data(), data.size());
+}
+
+bool SolverClient::ReadLine(std::string& line)
+{
+	if (m_socket == NO_SOCKET)
+		return false;
+
+	char chunk[4096];
+	size_t eol;
+	while ((eol = m_buffer.find('\n')) == std::string::npos) {
+		int received = Receive(m_socket, chunk, sizeof(chunk));
+		if (received <= 0)
+			return false;
+		m_buffer.append(chunk, received);
+	}
+
+	line = m_buffer.substr(0, eol);
+	m_buffer.erase(0, eol + 1);
+	return true;
+}
@@ -0,0 +1,167 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SolverService.h"
+#include "SolutionCache.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Settings for `SolverDaemon`
+ */
+struct SDaemonOptions
+{
+    std::string socket_path;            // file system path of the unix domain socket
+    int worker_count = 0;               // solver threads, 0 = one per core
+    int batch_size = 32;                // max requests a worker takes from the queue at once
+    int queue_capacity = 4096;          // max requests waiting to be solved (all connections)
+    size_t cache_budget = 16 * 1024 * 1024;  // solution cache size in bytes, 0 = no cache
+    SSolveLimits limits;                // budgets for each request
+};
+
+/**
+ * @class SolverDaemon
+ * @brief Local solver server, listening on a unix domain socket
+ *
+ * Clients use the same line protocol as `SolverService` (the `-p` mode).
+ * Any number of clients may connect at once, and each may pipeline requests.
+ *
+ * Requests from all connections go into a single bounded queue. Worker threads
+ * take requests from the queue in batches and solve them. Once the queue is
+ * full, connections stop reading from their sockets until there is room, which
+ * pushes the backpressure onto the clients.
+ *
+ * Responses are returned to each connection in the order its requests were
+ * received, regardless of which worker solved them. Each connection has its
+ * own writer thread, so a client that is slow to read its responses only
+ * holds up itself, never a worker or the reading of its requests.
+ */
+class SolverDaemon
+{
+public:
+
+    explicit SolverDaemon(const SDaemonOptions& options);
+    ~SolverDaemon();
+
+    SolverDaemon(const SolverDaemon&) = delete;
+    SolverDaemon& operator=(const SolverDaemon&) = delete;
+
+    /**
+     * @brief Creates the socket and starts accepting clients
+     * @return False if the socket could not be created
+     */
+    bool Start();
+
+    /**
+     * @brief Closes the socket and all connections, and stops the workers
+     */
+    void Stop();
+
+    /**
+     * @brief Blocks until the daemon has been stopped
+     */
+    void Wait();
+
+    uint64_t GetRequestCount() const { return m_requestCount.load(); }
+    uint64_t GetBatchCount() const { return m_batchCount.load(); }
+
+protected:
+
+    struct Connection {
+        ~Connection();
+
+        intptr_t socket;
+        std::thread reader;
+        std::thread writer;
+        std::mutex lock;                            // guards everything below. Never held while blocked on the socket.
+        std::condition_variable wake;               // signals the writer
+        uint64_t received = 0;                      // requests read so far
+        uint64_t sent = 0;                          // responses passed to the writer so far
+        std::map<uint64_t, std::string> completed;  // responses waiting for earlier ones
+        std::string outbox;                         // responses in order, waiting to be written
+        bool input_closed = false;
+        bool closed = false;
+    };
+
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        uint64_t sequence;
+        SServiceRequest request;
+    };
+
+    SDaemonOptions m_options;
+    intptr_t m_listener;
+    std::atomic<bool> m_stopping{ false };
+    std::unique_ptr<SolutionCache> m_cache;
+
+    std::mutex m_stateLock;
+    std::condition_variable m_stateChanged;
+    bool m_stopped = false;
+
+    std::thread m_acceptor;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_connectionsLock;
+    std::vector<std::shared_ptr<Connection>> m_connections;
+
+    // Pending work, shared by all connections.
+    std::mutex m_queueLock;
+    std::condition_variable m_queueNotEmpty;
+    std::condition_variable m_queueNotFull;
+    std::deque<Job> m_queue;
+
+    std::atomic<uint64_t> m_requestCount{ 0 };
+    std::atomic<uint64_t> m_batchCount{ 0 };
+
+    void AcceptConnections();
+    void ReadRequests(std::shared_ptr<Connection> connection);
+    void WriteResponses(std::shared_ptr<Connection> connection);
+    void SolveBatches();
+
+    bool Enqueue(Job&& job);
+    void Deliver(Connection& connection, uint64_t sequence, std::string&& response);
+};
+
+/**
+ * @class SolverClient
+ * @brief Minimal blocking client for `SolverDaemon`
+ */
+class SolverClient
+{
+public:
+    SolverClient();
+    ~SolverClient();
+
+    SolverClient(const SolverClient&) = delete;
+    SolverClient& operator=(const SolverClient&) = delete;
+
+    bool Connect(const std::string& socket_path);
+    void Close();
+
+    /**
+     * @brief Sends a single request line. The line terminator is added.
+     */
+    bool Send(const std::string& line);
+
+    /**
+     * @brief Reads the next response line, without the line terminator
+     * @return False if the connection has been closed
+     */
+    bool ReadLine(std::string& line);
+
+protected:
+    intptr_t m_socket;
+    std::string m_buffer;
+};
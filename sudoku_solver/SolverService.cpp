@@ -0,0 +1,116 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SolverService.h"
+#include "SBoardTables.h"
+#include "PuzzleParser.h"
+#include <iostream>
+#include <chrono>
+
+namespace {
+
+	std::string Trim(const std::string& s)
+	{
+		auto first = s.find_first_not_of(" \t\r\n");
+		if (first == std::string::npos)
+			return {};
+		auto last = s.find_last_not_of(" \t\r\n");
+		return s.substr(first, last - first + 1);
+	}
+}
+
+bool SolverService::ParseRequest(const std::string& line, SServiceRequest& request)
+{
+	request.id.clear();
+	request.puzzle.clear();
+
+	// NB: Leading/trailing spaces are trimmed, so spaces cannot be used as
+	//     empty cells at either end of a bare puzzle. Use '.' or '0' instead.
+	std::string text = Trim(line);
+	if (text.empty())
+		return false;
+
+	auto comma = text.find(',');
+	if (comma == std::string::npos) {
+		request.puzzle = text;
+		return true;
+	}
+
+	// Accept the `puzzle,solution` layout of the test data files as well as
+	// `id,puzzle`. A first field that looks like a puzzle is taken as one.
+	std::string first = Trim(text.substr(0, comma));
+	if (first.size() == SBoardTables::CellCount) {
+		request.puzzle = first;
+		return true;
+	}
+
+	auto next = text.find(',', comma + 1);
+	request.id = first;
+	request.puzzle = Trim(text.substr(comma + 1, (next == std::string::npos) ? std::string::npos : next - comma - 1));
+	return true;
+}
+
+std::string SolverService::SolveRequest(const SServiceRequest& request)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	const char* status = "invalid";
+	std::string solution;
+	int steps = 0;
+
+	SBoard board;
+	SBoard solved_board;
+	SParsedPuzzle parsed;
+	if (PuzzleParser::Parse(request.puzzle, parsed) == SParseResult::Ok) {
+		parsed.ToBoard(board);
+		auto result = m_solver.SolveWithStatus(board, &solved_board, steps);
+		status = SudokuSolver::GetStatusName(result);
+		if (result == SSolveStatus::Solved) {
+			solution.resize(SBoardTables::CellCount);
+			m_solver.GetBoardAsStringLayout(solved_board, &solution[0]);
+		}
+	}
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	std::string response;
+	response.reserve(request.id.size() + SBoardTables::CellCount + 32);
+	response += request.id;
+	response += ',';
+	response += status;
+	response += ',';
+	response += solution;
+	response += ',';
+	response += std::to_string(steps);
+	response += ',';
+	response += std::to_string(elapsed);
+	return response;
+}
+
+int SolverService::Run(std::istream& in, std::ostream& out)
+{
+	int count = 0;
+	std::string line;
+	SServiceRequest request;
+
+	while (std::getline(in, line)) {
+
+		if (!ParseRequest(line, request))
+			continue;
+
+		count++;
+		if (request.id.empty())
+			request.id = std::to_string(count);
+
+		out << SolveRequest(request) << '\n';
+
+		// Only flush when asked, or when the caller has nothing else queued.
+		if (m_flushEachResponse || (in.rdbuf()->in_avail() <= 0))
+			out.flush();
+	}
+
+	out.flush();
+	return count;
+}
@@ -0,0 +1,111 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SudokuSolver.h"
+#include <string>
+#include <iosfwd>
+
+/**
+ * @brief A single puzzle request, as read by the service
+ */
+struct SServiceRequest
+{
+    std::string id;         // caller supplied id, or the request sequence number
+    std::string puzzle;     // 81 character layout
+};
+
+/**
+ * @class SolverService
+ * @brief Long running solver, reading requests from a stream and writing responses
+ *
+ * Each input line is either a bare 81 character puzzle, or a record of the form
+ * `<id>,<puzzle>`. Puzzles use the same notation as `LoadBoardFromStringLayout()`,
+ * with '.' also accepted for empty cells. Blank lines are ignored.
+ *
+ * Each request produces one response line, in request order:
+ *
+ *     <id>,<status>,<solution>,<steps>,<microseconds>
+ *
+ * where status is one of `solved`, `unsolved` or `invalid`, or `timeout`,
+ * `nodelimit` or `cancelled` if the solve ran out of budget (see `SetLimits()`).
+ * The solution field is empty unless solved.
+ *
+ * Responses are not flushed per request. The output is flushed once the input
+ * has no further buffered requests, so that pipelined callers get batched
+ * writes while interactive callers still see every response.
+ */
+class SolverService
+{
+public:
+
+    /**
+     * @brief Processes requests until the input is exhausted
+     * @param in The request stream
+     * @param out The response stream
+     * @return The number of requests processed
+     */
+    int Run(std::istream& in, std::ostream& out);
+
+    /**
+     * @brief Parses a single request line
+     * @param line The input line, without the line terminator
+     * @param request Receives the request. The id is left empty if not supplied.
+     * @return False if the line holds no request (e.g. blank)
+     */
+    static bool ParseRequest(const std::string& line, SServiceRequest& request);
+
+    /**
+     * @brief Solves the given request
+     * @return The response line, without a line terminator
+     */
+    std::string SolveRequest(const SServiceRequest& request);
+
+    /**
+     * @brief If set, every response is flushed as soon as it is written
+     */
+    void SetFlushEachResponse(bool flush) { m_flushEachResponse = flush; }
+
+    /**
+     * @brief Sets the cache used by the underlying solver (optional, not owned)
+     */
+    void SetSolutionCache(SolutionCache* cache) { m_solver.SetSolutionCache(cache); }
+
+    /**
+     * @brief Sets the table of boards with no solution used by the underlying solver (optional, not owned)
+     */
+    void SetTranspositionTable(TranspositionTable* table) { m_solver.SetTranspositionTable(table); }
+
+    /**
+     * @brief Sets the budgets applied to each request
+     */
+    void SetLimits(const SSolveLimits& limits) { m_solver.SetLimits(limits); }
+
+    /**
+     * @brief Sets the search engine used for each request
+     */
+    void SetEngine(SSolverEngine engine) { m_solver.SetEngine(engine); }
+
+    /**
+     * @brief Hands each request over to the SAT engine after this many search nodes (0 for never)
+     */
+    void SetSatFallback(uint64_t max_nodes) { m_solver.SetSatFallback(max_nodes); }
+
+    /**
+     * @brief Sets the look-ahead before each guess, on cells with up to this many candidates (0 for none)
+     */
+    void SetProbing(int max_candidates) { m_solver.SetProbing(max_candidates); }
+
+    /**
+     * @brief Sets the order in which the search tries values
+     */
+    void SetValueOrder(SValueOrder order) { m_solver.SetValueOrder(order); }
+
+protected:
+
+    SudokuSolver m_solver;
+    bool m_flushEachResponse = false;
+};
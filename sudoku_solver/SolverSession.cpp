@@ -0,0 +1,259 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "SolverSession.h"
+#include "SBoardTables.h"
+#include <cstring>
+
+namespace {
+
+	constexpr int CELL_COUNT = SBoardTables::CellCount;
+}
+
+SolverSession::SolverSession()
+{
+	Reset(SBoard{});
+}
+
+SolverSession::SolverSession(const SBoard& board)
+{
+	Reset(board);
+}
+
+int SolverSession::ToCell(SPos pos)
+{
+	if ((pos.col < 0) || (pos.col >= BOARD_SIZE) || (pos.row < 0) || (pos.row >= BOARD_SIZE))
+		return -1;
+	return pos.GetBoardIndex();
+}
+
+void SolverSession::Reset(const SBoard& board)
+{
+	std::memset(m_values, 0, sizeof(m_values));
+	std::memset(m_isGiven, 0, sizeof(m_isGiven));
+	std::memset(m_eliminated, 0, sizeof(m_eliminated));
+	std::memset(m_peerCount, 0, sizeof(m_peerCount));
+	std::memset(m_placed, 0, sizeof(m_placed));
+	std::memset(m_places, BOARD_SIZE, sizeof(m_places));
+	for (auto& mask : m_candidates) {
+		mask = SUnitMasks::AllCandidates;
+	}
+
+	m_emptyCells = 0;
+	m_conflicts = 0;
+	m_deadDigits = 0;
+	m_trail.clear();
+	m_uniqueState = -1;
+
+	for (int cell = 0; cell < CELL_COUNT; cell++) {
+		SCell c = board.GetCell(g_boardTables.col[cell], g_boardTables.row[cell]);
+		if (c.value != SValueEnum::SValue_Empty) {
+			AddValue(cell, static_cast<int>(c.value));
+			m_isGiven[cell] = (c.state == SStateEnum::SState_Fixed);
+		}
+	}
+}
+
+bool SolverSession::Place(SPos pos, SValueEnum value)
+{
+	int cell = ToCell(pos);
+	if ((cell < 0) || m_isGiven[cell])
+		return false;
+
+	m_trail.push_back({ static_cast<uint8_t>(cell), m_values[cell], 0 });
+	SetValue(cell, static_cast<int>(value));
+	return true;
+}
+
+bool SolverSession::Clear(SPos pos)
+{
+	return Place(pos, SValueEnum::SValue_Empty);
+}
+
+bool SolverSession::Eliminate(SPos pos, SValueEnum value)
+{
+	int cell = ToCell(pos);
+	int digit = static_cast<int>(value) - 1;
+	if ((cell < 0) || (digit < 0) || (digit >= BOARD_SIZE) || (m_values[cell] != 0) || !(m_candidates[cell] & (1 << digit)))
+		return false;
+
+	m_trail.push_back({ static_cast<uint8_t>(cell), 0, static_cast<uint8_t>(value) });
+	m_uniqueState = -1;
+	m_eliminated[cell] |= (1 << digit);
+	RemoveCandidate(cell, digit);
+	return true;
+}
+
+bool SolverSession::Undo()
+{
+	if (m_trail.empty())
+		return false;
+
+	Edit edit = m_trail.back();
+	m_trail.pop_back();
+	if (edit.eliminated == 0) {
+		SetValue(edit.cell, edit.previous);
+		return true;
+	}
+
+	// Later edits have been undone, so the cell is free again, with the same peers.
+	int digit = edit.eliminated - 1;
+	m_uniqueState = -1;
+	m_eliminated[edit.cell] &= ~(1 << digit);
+	if ((m_values[edit.cell] == 0) && (m_peerCount[edit.cell][digit] == 0))
+		AddCandidate(edit.cell, digit);
+	return true;
+}
+
+uint16_t SolverSession::Candidates(SPos pos) const
+{
+	int cell = ToCell(pos);
+	if ((cell < 0) || (m_values[cell] != 0))
+		return 0;
+	return m_candidates[cell];
+}
+
+SValueEnum SolverSession::GetValue(SPos pos) const
+{
+	int cell = ToCell(pos);
+	return (cell < 0) ? SValueEnum::SValue_Empty : static_cast<SValueEnum>(m_values[cell]);
+}
+
+bool SolverSession::IsContradiction() const
+{
+	return (m_conflicts > 0) || (m_emptyCells > 0) || (m_deadDigits > 0);
+}
+
+bool SolverSession::HasUniqueCompletion()
+{
+	if (m_uniqueState >= 0)
+		return (m_uniqueState == 1);
+
+	m_uniqueState = 0;
+	if (IsContradiction())
+		return false;
+
+	SUnitMasks masks;
+	if (!masks.Load(m_values))
+		return false;
+
+	m_uniqueState = (masks.CountCompletions(2, m_eliminated) == 1) ? 1 : 0;
+	return (m_uniqueState == 1);
+}
+
+SBoard SolverSession::GetBoard() const
+{
+	SBoard board;
+	for (int cell = 0; cell < CELL_COUNT; cell++) {
+		if (m_values[cell] != 0) {
+			board.SetCell(g_boardTables.col[cell], g_boardTables.row[cell], SCell{
+				static_cast<SValueEnum>(m_values[cell]),
+				m_isGiven[cell] ? SStateEnum::SState_Fixed : SStateEnum::SState_Solved });
+		}
+	}
+	return board;
+}
+
+void SolverSession::SetValue(int cell, int value)
+{
+	m_uniqueState = -1;
+	if (m_values[cell] != 0)
+		RemoveValue(cell);
+	if (value != 0)
+		AddValue(cell, value);
+}
+
+/*
+* Fills a free cell. Its own candidates no longer count towards its units,
+* and the digit is removed from the candidates of its peers (unless already
+* ruled out there).
+*/
+void SolverSession::AddValue(int cell, int value)
+{
+	for (int digit = 0; digit < BOARD_SIZE; digit++) {
+		if (m_candidates[cell] & (1 << digit))
+			AdjustPlaces(cell, digit, -1);
+	}
+	if (m_candidates[cell] == 0)
+		m_emptyCells--;
+	m_candidates[cell] = 0;
+
+	int digit = value - 1;
+	m_values[cell] = static_cast<uint8_t>(value);
+	m_conflicts += m_peerCount[cell][digit];
+	AdjustPlaced(cell, digit, +1);
+
+	for (int peer : g_boardTables.peers[cell]) {
+		if ((m_peerCount[peer][digit]++ == 0) && (m_values[peer] == 0) && !(m_eliminated[peer] & (1 << digit)))
+			RemoveCandidate(peer, digit);
+	}
+}
+
+/*
+* Empties a filled cell. This is the reverse of AddValue().
+*/
+void SolverSession::RemoveValue(int cell)
+{
+	int digit = m_values[cell] - 1;
+	for (int peer : g_boardTables.peers[cell]) {
+		if ((--m_peerCount[peer][digit] == 0) && (m_values[peer] == 0) && !(m_eliminated[peer] & (1 << digit)))
+			AddCandidate(peer, digit);
+	}
+
+	AdjustPlaced(cell, digit, -1);
+	m_conflicts -= m_peerCount[cell][digit];
+	m_values[cell] = 0;
+
+	uint16_t mask = 0;
+	for (int d = 0; d < BOARD_SIZE; d++) {
+		if ((m_peerCount[cell][d] == 0) && !(m_eliminated[cell] & (1 << d))) {
+			mask |= (1 << d);
+			AdjustPlaces(cell, d, +1);
+		}
+	}
+	m_candidates[cell] = mask;
+	if (mask == 0)
+		m_emptyCells++;
+}
+
+void SolverSession::AddCandidate(int cell, int digit)
+{
+	if (m_candidates[cell] == 0)
+		m_emptyCells--;
+	m_candidates[cell] |= (1 << digit);
+	AdjustPlaces(cell, digit, +1);
+}
+
+void SolverSession::RemoveCandidate(int cell, int digit)
+{
+	m_candidates[cell] &= ~(1 << digit);
+	if (m_candidates[cell] == 0)
+		m_emptyCells++;
+	AdjustPlaces(cell, digit, -1);
+}
+
+/*
+* A digit is dead in a unit when it is neither placed nor has anywhere left
+* to go. These two keep count of dead digits as the unit counts change.
+*/
+void SolverSession::AdjustPlaces(int cell, int digit, int delta)
+{
+	for (int unit : g_boardTables.units[cell]) {
+		bool was_dead = (m_placed[unit][digit] == 0) && (m_places[unit][digit] == 0);
+		m_places[unit][digit] = static_cast<uint8_t>(m_places[unit][digit] + delta);
+		bool is_dead = (m_placed[unit][digit] == 0) && (m_places[unit][digit] == 0);
+		m_deadDigits += static_cast<int>(is_dead) - static_cast<int>(was_dead);
+	}
+}
+
+void SolverSession::AdjustPlaced(int cell, int digit, int delta)
+{
+	for (int unit : g_boardTables.units[cell]) {
+		bool was_dead = (m_placed[unit][digit] == 0) && (m_places[unit][digit] == 0);
+		m_placed[unit][digit] = static_cast<uint8_t>(m_placed[unit][digit] + delta);
+		bool is_dead = (m_placed[unit][digit] == 0) && (m_places[unit][digit] == 0);
+		m_deadDigits += static_cast<int>(is_dead) - static_cast<int>(was_dead);
+	}
+}
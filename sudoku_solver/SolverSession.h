@@ -0,0 +1,139 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include "SBoard.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class SolverSession
+ * @brief Stateful board for interactive clients, updated incrementally per edit
+ *
+ * Rather than re-evaluating the whole board after each edit, the session keeps
+ * the candidates of every cell, and for every unit how many cells could still
+ * take each digit. An edit only touches the 20 peers of the changed cell (and
+ * their 3 units), so `Place()`, `Clear()` and `Undo()` cost the same no matter
+ * how full the board is, and `IsContradiction()` is a constant time check.
+ *
+ * Candidates can also be ruled out directly, by `Eliminate()`, as the hints
+ * of `HintEngine` other than singles do. These stay ruled out, whatever else
+ * is placed or cleared, until the elimination is undone.
+ *
+ * Candidate masks use bit (value - 1), i.e. 0x1FF means all of 1 - 9.
+ */
+class SolverSession
+{
+public:
+
+    SolverSession();
+
+    /**
+     * @brief Starts the session from the given board. Cells in the fixed state
+     *        become givens, which cannot be changed.
+     */
+    explicit SolverSession(const SBoard& board);
+
+    /**
+     * @brief Restarts the session from the given board, and clears the undo history
+     */
+    void Reset(const SBoard& board);
+
+    /**
+     * @brief Sets the value of a cell, replacing any previous (non given) value
+     *
+     * Values that clash with a peer are accepted, and reported through
+     * `IsContradiction()`.
+     *
+     * @return False if the position is out of range or holds a given
+     */
+    bool Place(SPos pos, SValueEnum value);
+
+    /**
+     * @brief Empties a cell
+     * @return False if the position is out of range or holds a given
+     */
+    bool Clear(SPos pos);
+
+    /**
+     * @brief Rules out a candidate of a free cell
+     * @return False if the position is out of range or filled, or the value
+     *         is not a candidate of the cell
+     */
+    bool Eliminate(SPos pos, SValueEnum value);
+
+    /**
+     * @brief Reverts the most recent `Place()`, `Clear()` or `Eliminate()`
+     * @return False if there is nothing to undo
+     */
+    bool Undo();
+
+    /**
+     * @brief Returns the candidate mask of a free cell, or 0 for a filled cell
+     */
+    uint16_t Candidates(SPos pos) const;
+
+    /**
+     * @brief Tests whether the board can no longer be completed
+     *
+     * True if two peers share a value, a free cell has no candidates left, or
+     * a unit has a digit that can no longer be placed anywhere.
+     */
+    bool IsContradiction() const;
+
+    /**
+     * @brief Tests whether the board has exactly one completion
+     *
+     * This requires a search (stopping at the second solution), which keeps
+     * to the candidates left by `Eliminate()`. The result is kept until the
+     * next edit.
+     */
+    bool HasUniqueCompletion();
+
+    SValueEnum GetValue(SPos pos) const;
+
+    /**
+     * @brief Returns the board, with givens fixed and placed values solved
+     */
+    SBoard GetBoard() const;
+
+    size_t GetUndoDepth() const { return m_trail.size(); }
+
+protected:
+
+    struct Edit {
+        uint8_t cell;
+        uint8_t previous;
+        uint8_t eliminated;     // the value ruled out by Eliminate(), or 0 for a value edit
+    };
+
+    uint8_t  m_values[BOARD_SIZE * BOARD_SIZE];
+    bool     m_isGiven[BOARD_SIZE * BOARD_SIZE];
+    uint16_t m_candidates[BOARD_SIZE * BOARD_SIZE];             // free cells only
+    uint16_t m_eliminated[BOARD_SIZE * BOARD_SIZE];             // ruled out by Eliminate()
+    uint8_t  m_peerCount[BOARD_SIZE * BOARD_SIZE][BOARD_SIZE];  // peers holding each digit
+    uint8_t  m_places[3 * BOARD_SIZE][BOARD_SIZE];              // free cells in unit that can take digit
+    uint8_t  m_placed[3 * BOARD_SIZE][BOARD_SIZE];              // cells in unit holding digit
+
+    int m_emptyCells = 0;       // free cells without candidates
+    int m_conflicts = 0;        // pairs of peers holding the same value
+    int m_deadDigits = 0;       // (unit, digit) pairs neither placed nor placeable
+
+    std::vector<Edit> m_trail;
+
+    int m_uniqueState = -1;     // cached HasUniqueCompletion() result, -1 = unknown
+
+    void SetValue(int cell, int value);
+    void AddValue(int cell, int value);
+    void RemoveValue(int cell);
+    void AddCandidate(int cell, int digit);
+    void RemoveCandidate(int cell, int digit);
+    void AdjustPlaces(int cell, int digit, int delta);
+    void AdjustPlaced(int cell, int digit, int delta);
+
+    static int ToCell(SPos pos);
+};
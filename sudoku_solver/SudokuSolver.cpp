@@ -4,77 +4,307 @@
 */
 
 #include "SudokuSolver.h"
-#include <map>
+#include "SolutionCache.h"
+#include "TranspositionTable.h"
+#include "BitboardSolver.h"
+#include "SatSolver.h"
+#include "SBoardTables.h"
+#include <algorithm>
 #include <random>
 
-
 /*
-* Finds values for cells through a process of eliminating all other possibilities.
-* Return true if any addition to the board has been made.
+* Solve budgets
 */
-bool SudokuSolver::FindByElimination(SBoard& board)
+void SSolveBudget::Start(const SSolveLimits& solve_limits)
 {
-	// Stores: (value within a block) => [set of cell coord]
-	using ValueLookupMap = std::map< SValueEnum, std::set<SPos> >;
-
-	// For each block on our board, we will monitor the free cells.
-	// Keeping a list of all valid values for each cell (within a block).
-	// Each block stores: [value] => {valid cells list}
-	std::vector< ValueLookupMap > openBlocks(BOARD_SIZE);
+	limits = solve_limits;
+	if (limits.max_seconds > 0.0) {
+		deadline = std::chrono::steady_clock::now() +
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(limits.max_seconds));
+	}
+}
 
-	for (auto nblock : { 0,1,2,3,4,5,6,7,8 }) {
+bool SSolveBudget::IsSpent(uint64_t nodes, SSolveStatus& status) const
+{
+	if (limits.cancel && limits.cancel->load(std::memory_order_relaxed)) {
+		status = SSolveStatus::Cancelled;
+		return true;
+	}
+	if (limits.max_nodes && (nodes > limits.max_nodes)) {
+		status = SSolveStatus::NodeLimit;
+		return true;
+	}
+	if ((limits.max_seconds > 0.0) && (std::chrono::steady_clock::now() >= deadline)) {
+		status = SSolveStatus::TimedOut;
+		return true;
+	}
+	return false;
+}
 
-		int start_column = (nblock % BLOCK_SIZE) * BLOCK_SIZE;
-		int start_row = (nblock / BLOCK_SIZE) * BLOCK_SIZE;
-		int bindex = (start_row * BOARD_SIZE) + start_column;
+namespace {
+
+	constexpr uint16_t ALL_CANDIDATES = (1u << BOARD_SIZE) - 1;
+
+	enum SProbeState : uint8_t {
+		SProbeState_Free,
+		SProbeState_Pending,		// placed, its peers not yet updated
+		SProbeState_Done
+	};
+
+	/*
+	* The candidates of every cell, for the look-ahead. A placed cell holds the
+	* bit of its value. It is small enough to copy onto the stack for each probe.
+	*/
+	struct SProbeGrid
+	{
+		uint16_t candidates[SBoardTables::CellCount];
+		SProbeState states[SBoardTables::CellCount];
+	};
+
+	bool IsSingleBit(unsigned int bits)
+	{
+		return (bits != 0) && ((bits & (bits - 1)) == 0);
+	}
 
-		for (int r = 0; r < BLOCK_SIZE; r++) {
-			for (int c = 0; c < BLOCK_SIZE; c++) {
+	/*
+	* Orders the values of a free cell by the number of free peers that still
+	* have the value as a candidate, fewest first. These values take the fewest
+	* candidates from the rest of the board. Ties are in ascending order.
+	*/
+	void OrderByLeastConstraining(const SBoard& board, int cell, int (&values)[BOARD_SIZE])
+	{
+		unsigned int placed[SBoardTables::UnitCount] = {};
+		for (int i = 0; i < SBoardTables::CellCount; i++) {
+			int value = static_cast<int>(board.GetCellDirect(i).value);
+			if (value == 0)
+				continue;
+
+			for (auto unit : g_boardTables.units[i]) {
+				placed[unit] |= 1u << (value - 1);
+			}
+		}
 
-				int block_index = (r * BOARD_SIZE) + c + bindex;
-				auto& cell = board.GetCellDirect(block_index);
-				if (cell.IsSolved())
-					continue;
+		int costs[BOARD_SIZE] = {};
+		for (auto peer : g_boardTables.peers[cell]) {
+			if (board.GetCellDirect(peer).value != SValueEnum::SValue_Empty)
+				continue;
 
-				// If any of the values are valid for this cell, then add to 
-				// collection
-				for (auto& v : { 1,2,3,4,5,6,7,8,9 }) {
+			const auto& units = g_boardTables.units[peer];
+			unsigned int candidates = ~(placed[units[0]] | placed[units[1]] | placed[units[2]]) & ALL_CANDIDATES;
+			for (int digit = 0; digit < BOARD_SIZE; digit++) {
+				costs[digit] += (candidates >> digit) & 1;
+			}
+		}
 
-					SValueEnum testValue = static_cast<SValueEnum>(v);
-					if (board.IsValueValidAt(cell.position, testValue)) {
+		for (int digit = 0; digit < BOARD_SIZE; digit++) {
+			values[digit] = digit + 1;
+		}
+		std::stable_sort(std::begin(values), std::end(values), [&costs](int a, int b) { return costs[a - 1] < costs[b - 1]; });
+	}
 
-						auto it = openBlocks[nblock].insert({ testValue, {} });
-						it.first->second.insert(cell.position);
+	/*
+	* Follows the naked and hidden singles of the pending cells, until there
+	* are none left. Returns false on a contradiction.
+	*/
+	bool PropagateProbe(SProbeGrid& grid)
+	{
+		bool has_pending = true;
+		while (has_pending) {
+
+			// A placed value is removed from the candidates of its peers.
+			for (bool has_placed = true; has_placed; ) {
+				has_placed = false;
+				for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+					if (grid.states[cell] != SProbeState_Pending)
+						continue;
+
+					grid.states[cell] = SProbeState_Done;
+					uint16_t bit = grid.candidates[cell];
+					for (auto peer : g_boardTables.peers[cell]) {
+						if (!(grid.candidates[peer] & bit))
+							continue;
+
+						if (grid.states[peer] != SProbeState_Free)
+							return false;
+
+						grid.candidates[peer] &= ~bit;
+						if (grid.candidates[peer] == 0)
+							return false;
+
+						if (IsSingleBit(grid.candidates[peer])) {
+							grid.states[peer] = SProbeState_Pending;
+							has_placed = true;
+						}
+					}
+				}
+			}
 
+			// A value with one place left in a unit goes there.
+			has_pending = false;
+			for (const auto& unit : g_boardTables.cells) {
+				unsigned int once = 0;
+				unsigned int twice = 0;
+				for (auto cell : unit) {
+					twice |= once & grid.candidates[cell];
+					once |= grid.candidates[cell];
+				}
+				if (once != ALL_CANDIDATES)
+					return false;
+
+				for (unsigned int singles = once & ~twice; singles != 0; singles &= singles - 1) {
+					uint16_t bit = static_cast<uint16_t>(singles & (0u - singles));
+					for (auto cell : unit) {
+						if ((grid.candidates[cell] & bit) && (grid.states[cell] == SProbeState_Free)) {
+							grid.candidates[cell] = bit;
+							grid.states[cell] = SProbeState_Pending;
+							has_pending = true;
+						}
 					}
 				}
 			}
 		}
+		return true;
 	}
+}
+
+/*
+* Finds values for cells through a process of eliminating all other possibilities.
+* Return true if any addition to the board has been made.
+*/
+bool SudokuSolver::FindByElimination(SBoard& board)
+{
+	return Eliminate(board) == SEliminationResult::Progress;
+}
 
-	// Check for any definitive solution
+/*
+* Values with only one valid cell left within a block are solved (hidden
+* singles). Candidates are kept as bit masks, bit (value - 1), as SolverSession.
+*/
+SEliminationResult SudokuSolver::Eliminate(SBoard& board)
+{
+	constexpr unsigned int ALL_VALUES = (1u << BOARD_SIZE) - 1;
+
+	// Values already placed in each row, column and block. A value placed
+	// twice in a unit means the board is already broken.
+	unsigned int placed[SBoardTables::UnitCount] = {};
+	for (int i = 0; i < SBoardTables::CellCount; i++) {
+		int value = static_cast<int>(board.GetCellDirect(i).value);
+		if (value == 0)
+			continue;
+
+		unsigned int bit = 1u << (value - 1);
+		for (auto unit : g_boardTables.units[i]) {
+			if (placed[unit] & bit)
+				return SEliminationResult::Contradiction;
+			placed[unit] |= bit;
+		}
+	}
+
+	// Every free cell needs at least one candidate.
+	unsigned int candidates[SBoardTables::CellCount] = {};
+	for (int i = 0; i < SBoardTables::CellCount; i++) {
+		if (board.GetCellDirect(i).IsSolved())
+			continue;
+
+		const auto& units = g_boardTables.units[i];
+		candidates[i] = ~(placed[units[0]] | placed[units[1]] | placed[units[2]]) & ALL_VALUES;
+		if (candidates[i] == 0)
+			return SEliminationResult::Contradiction;
+	}
+
+	// Every value needs a place in every unit. In blocks, the values with only
+	// one place left are noted for the commit below.
+	unsigned int singles[BOARD_SIZE] = {};
+	for (int unit = 0; unit < SBoardTables::UnitCount; unit++) {
+		unsigned int once = 0;
+		unsigned int twice = 0;
+		for (auto cell : g_boardTables.cells[unit]) {
+			twice |= once & candidates[cell];
+			once |= candidates[cell];
+		}
+		if ((once | placed[unit]) != ALL_VALUES)
+			return SEliminationResult::Contradiction;
+
+		if (unit >= SBoardTables::FirstBlockUnit)
+			singles[unit - SBoardTables::FirstBlockUnit] = once & ~twice;
+	}
+
+	// Commit the hidden singles. They were all found from the same board, so
+	// any two that clash (same cell, or same value in a unit) mean there is no
+	// solution.
 	bool aSolutionFound = false;
-	for (auto& block : openBlocks) {
-		for (auto& validvalues : block) {
-			if (validvalues.second.size() == 1) {
-				board.SetCell(
-					validvalues.second.begin()->col,
-					validvalues.second.begin()->row,
-					{ validvalues.first, SStateEnum::SState_Solved }	// value/state
-				);
-				aSolutionFound = true;
+	for (int nblock = 0; nblock < BOARD_SIZE; nblock++) {
+		for (unsigned int remaining = singles[nblock]; remaining != 0; remaining &= remaining - 1) {
+			unsigned int bit = remaining & (0u - remaining);
+
+			int index = 0;
+			for (auto cell : g_boardTables.cells[SBoardTables::FirstBlockUnit + nblock]) {
+				if (candidates[cell] & bit) {
+					index = cell;
+					break;
+				}
+			}
+
+			const auto& units = g_boardTables.units[index];
+			if (board.GetCellDirect(index).IsSolved() || ((placed[units[0]] | placed[units[1]] | placed[units[2]]) & bit))
+				return SEliminationResult::Contradiction;
+
+			int value = 1;
+			while (!(bit & (1u << (value - 1))))
+				value++;
+
+			board.SetCell(g_boardTables.col[index], g_boardTables.row[index], { static_cast<SValueEnum>(value), SStateEnum::SState_Solved });
+			for (auto unit : units) {
+				placed[unit] |= bit;
 			}
+			aSolutionFound = true;
 		}
 	}
-	return aSolutionFound;
+	return aSolutionFound ? SEliminationResult::Progress : SEliminationResult::NoChange;
 }
 
 /*
-*
+* Called from outside a solve, so it starts the state of one.
 */
 bool SudokuSolver::SolveBoardByRecursion(SBoard board, SBoard* pBoard /*= nullptr*/, int& steps)
 {
-	FindByElimination(board);
+	m_budget.Start(m_limits);
+	m_isAborted = false;
+	m_nodes = 0;
+	return SearchBoard(std::move(board), pBoard, steps);
+}
+
+/*
+*
+*/
+bool SudokuSolver::SearchBoard(SBoard board, SBoard* pBoard, int& steps)
+{
+	if (m_isAborted)
+		return false;
+
+	m_nodes++;
+	if (m_budget.IsSpent(m_nodes, m_abortStatus)) {
+		m_isAborted = true;
+		return false;
+	}
+
+	// Boards already searched without a solution need not be searched again.
+	uint64_t given_hash = board.GetHash();
+	if (m_table && m_table->IsDead(given_hash))
+		return false;
+
+	// Nothing below a contradiction can be solved.
+	if (Eliminate(board) == SEliminationResult::Contradiction) {
+		if (m_table)
+			m_table->AddDead(given_hash);
+		return false;
+	}
+
+	uint64_t hash = board.GetHash();
+	if (m_table && (hash != given_hash) && m_table->IsDead(hash)) {
+		m_table->AddDead(given_hash);
+		return false;
+	}
 
 	if (board.IsBoardSolved()) {
 
@@ -86,10 +316,28 @@ bool SudokuSolver::SolveBoardByRecursion(SBoard board, SBoard* pBoard /*= nullpt
 		return true;
 	}
 
-	steps++;
+	// Look ahead before guessing. Values found by the probes make a new
+	// board, searched as the next node.
+	if (m_probeCandidates != 0) {
+		auto result = Probe(board);
+		if (result == SEliminationResult::Progress) {
+			if (SearchBoard(board, pBoard, steps))
+				return true;
 
-	std::random_device rd;
-	std::mt19937 g(rd());
+			if (m_isAborted)
+				return false;
+		}
+
+		if (result != SEliminationResult::NoChange) {
+			if (m_table) {
+				m_table->AddDead(given_hash);
+				m_table->AddDead(hash);
+			}
+			return false;
+		}
+	}
+
+	steps++;
 
 	// Find next free cell
 	for (auto j = 0; j < BOARD_SIZE; j++) {
@@ -100,10 +348,17 @@ bool SudokuSolver::SolveBoardByRecursion(SBoard board, SBoard* pBoard /*= nullpt
 				// Go through all the possible values and see if we have solved
 				// the board.
 				//
-				// NB: Randomly shuffle the order. This is useful if we are generating
-				//     from a blank canvas.
-				std::vector<int> seq{ 1,2,3,4,5,6,7,8,9 };
-				std::shuffle(seq.begin(), seq.end(), g);
+				// NB: By default, randomly shuffle the order, as the search always
+				//     has, so that existing callers see no change.
+				int seq[BOARD_SIZE] = { 1,2,3,4,5,6,7,8,9 };
+				if (m_valueOrder == SValueOrder::LeastConstraining) {
+					OrderByLeastConstraining(board, cell.position.GetBoardIndex(), seq);
+				}
+				else {
+					std::random_device rd;
+					std::mt19937 g(rd());
+					std::shuffle(std::begin(seq), std::end(seq), g);
+				}
 
 				for (auto& v : seq) {
 					SValueEnum testValue = static_cast<SValueEnum>(v);
@@ -112,15 +367,24 @@ bool SudokuSolver::SolveBoardByRecursion(SBoard board, SBoard* pBoard /*= nullpt
 						cell.state = SStateEnum::SState_New;
 						board.SetCell(cell.position.col, cell.position.row, cell);
 
-						if (SolveBoardByRecursion(board, pBoard, steps))
+						if (SearchBoard(board, pBoard, steps))
 						{
 							return true;
 						}
+
+						if (m_isAborted)
+							return false;
 					}
 				}
 
 				board.SetCell(cell.position.col, cell.position.row, SCell{});
 
+				// Every value has been tried, so the board has no solution.
+				if (m_table) {
+					m_table->AddDead(given_hash);
+					m_table->AddDead(hash);
+				}
+
 				// copy solved board 
 				if (pBoard != nullptr) {
 					*pBoard = board;
@@ -133,14 +397,93 @@ bool SudokuSolver::SolveBoardByRecursion(SBoard board, SBoard* pBoard /*= nullpt
 	return false;
 }
 
+/*
+* Each probe places one candidate of a cell on a copy of the candidates, and
+* follows its singles. A candidate whose probe ends in a contradiction is
+* ruled out, and so is any value of another cell that none of the surviving
+* probes of the cell leave open. Passes repeat until nothing changes. Only
+* placed values can be kept on the board, so other narrowed candidates are
+* lost once the probe returns.
+*/
+SEliminationResult SudokuSolver::Probe(SBoard& board)
+{
+	SProbeGrid grid;
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		int value = static_cast<int>(board.GetCellDirect(cell).value);
+		grid.candidates[cell] = value ? static_cast<uint16_t>(1u << (value - 1)) : ALL_CANDIDATES;
+		grid.states[cell] = value ? SProbeState_Pending : SProbeState_Free;
+	}
+	if (!PropagateProbe(grid))
+		return SEliminationResult::Contradiction;
+
+	int max_candidates = (m_probeCandidates > 0) ? m_probeCandidates : BOARD_SIZE;
+	for (bool has_narrowed = true; has_narrowed; ) {
+		has_narrowed = false;
+
+		for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+			if ((grid.states[cell] != SProbeState_Free) || (CountBits(grid.candidates[cell]) > max_candidates))
+				continue;
+
+			uint16_t open[SBoardTables::CellCount] = {};
+			for (unsigned int remaining = grid.candidates[cell]; remaining != 0; remaining &= remaining - 1) {
+				SProbeGrid trial = grid;
+				trial.candidates[cell] = static_cast<uint16_t>(remaining & (0u - remaining));
+				trial.states[cell] = SProbeState_Pending;
+				if (!PropagateProbe(trial))
+					continue;
+
+				for (int i = 0; i < SBoardTables::CellCount; i++) {
+					open[i] |= trial.candidates[i];
+				}
+			}
+
+			// No candidate of the cell survives, so the board has no solution.
+			if (open[cell] == 0)
+				return SEliminationResult::Contradiction;
+
+			for (int i = 0; i < SBoardTables::CellCount; i++) {
+				if ((grid.states[i] != SProbeState_Free) || !(grid.candidates[i] & ~open[i]))
+					continue;
+
+				grid.candidates[i] &= open[i];
+				if (IsSingleBit(grid.candidates[i]))
+					grid.states[i] = SProbeState_Pending;
+				has_narrowed = true;
+			}
+
+			if (has_narrowed && !PropagateProbe(grid))
+				return SEliminationResult::Contradiction;
+		}
+	}
+
+	bool aSolutionFound = false;
+	for (int cell = 0; cell < SBoardTables::CellCount; cell++) {
+		if ((grid.states[cell] == SProbeState_Free) || (board.GetCellDirect(cell).value != SValueEnum::SValue_Empty))
+			continue;
+
+		int value = 1;
+		while (!(grid.candidates[cell] & (1u << (value - 1))))
+			value++;
+
+		board.SetCell(g_boardTables.col[cell], g_boardTables.row[cell], { static_cast<SValueEnum>(value), SStateEnum::SState_Solved });
+		aSolutionFound = true;
+	}
+	return aSolutionFound ? SEliminationResult::Progress : SEliminationResult::NoChange;
+}
+
 bool SudokuSolver::SolveBoardByElimination(SBoard& board, int& steps)
 {
 	bool is_solved = false;
 
 	while (!is_solved) {
-		bool boardHasChanged = FindByElimination(board);
+		auto result          = Eliminate(board);
+		bool boardHasChanged = (result == SEliminationResult::Progress);
 		is_solved            = board.IsBoardSolved();
 
+		// The recursion will find the same contradiction on its first step.
+		if (result == SEliminationResult::Contradiction)
+			break;
+
 		// Give up if we are stuck.
 		if (!is_solved && !boardHasChanged)
 			break;
@@ -200,16 +543,149 @@ bool SudokuSolver::ReverseSolve(SBoard& board)
 
 bool SudokuSolver::Solve(SBoard& board, SBoard* board_ptr, int& steps)
 {
-	bool has_solved = SolveBoardByElimination(board, steps);
+	return SolveWithStatus(board, board_ptr, steps) == SSolveStatus::Solved;
+}
 
-	if (has_solved && board_ptr) {
-		*board_ptr = board;
+SSolveStatus SudokuSolver::SolveWithStatus(SBoard& board, SBoard* board_ptr, int& steps)
+{
+	// With a SAT fallback, the engine only gets the nodes up to the handover.
+	SSolveLimits limits = m_limits;
+	bool has_fallback = (m_satFallbackNodes != 0) && (m_engine != SSolverEngine::Sat) &&
+		((limits.max_nodes == 0) || (m_satFallbackNodes < limits.max_nodes));
+	if (has_fallback) {
+		limits.max_nodes = m_satFallbackNodes;
+	}
+
+	m_budget.Start(limits);
+	m_isAborted = false;
+	m_nodes = 0;
+
+	// A hit copies the solution straight into the free cells of the result,
+	// without any allocation.
+	char layout[BOARD_SIZE * BOARD_SIZE];
+	if (m_cache) {
+		GetBoardAsStringLayout(board, layout);
+
+		char solution[BOARD_SIZE * BOARD_SIZE];
+		int cached_steps = 0;
+		bool cached_solved = false;
+		if (m_cache->Lookup(layout, solution, cached_steps, cached_solved)) {
+			steps += cached_steps;
+			if (cached_solved && board_ptr) {
+				*board_ptr = board;
+				for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+					if (layout[i] == '0') {
+						SCell& cell = board_ptr->GetCellDirect(i);
+						cell.value = static_cast<SValueEnum>(solution[i] - '0');
+						cell.state = SStateEnum::SState_Solved;
+					}
+				}
+				board_ptr->UpdateHash();
+			}
+			else if (board_ptr) {
+				board_ptr->ClearBoard();
+			}
+			return cached_solved ? SSolveStatus::Solved : SSolveStatus::Unsolved;
+		}
+	}
+
+	int start_steps = steps;
+	SBoard solved_board;
+	bool has_solved = false;
+
+	// The other engines keep their own search state. Their nodes add to ours.
+	auto solve_with = [&](auto& engine, const SSolveLimits& engine_limits) {
+		engine.SetLimits(engine_limits);
+		auto result = engine.SolveWithStatus(board, &solved_board, steps);
+		m_nodes += engine.GetNodeCount();
+		m_isAborted = (result != SSolveStatus::Solved) && (result != SSolveStatus::Unsolved);
+		m_abortStatus = result;
+		return (result == SSolveStatus::Solved);
+	};
+
+	if (m_engine == SSolverEngine::Bitboard) {
+		BitboardSolver bitboard;
+		has_solved = solve_with(bitboard, limits);
+	}
+	else if (m_engine == SSolverEngine::Sat) {
+		SatSolver sat;
+		has_solved = solve_with(sat, limits);
 	}
 	else {
-		has_solved = SolveBoardByRecursion(board, board_ptr, steps);
+		// The elimination works on a copy, so the board is left as given, as
+		// by the other engines and by a cache hit.
+		SBoard working(board);
+		has_solved = SolveBoardByElimination(working, steps);
+
+		if (has_solved) {
+			solved_board = std::move(working);
+		}
+		else {
+			has_solved = SearchBoard(std::move(working), &solved_board, steps);
+		}
+	}
+
+	// A board over the handover node count is given to the SAT engine, with
+	// what is left of the budget.
+	if (has_fallback && m_isAborted && (m_abortStatus == SSolveStatus::NodeLimit)) {
+		SSolveLimits sat_limits = m_limits;
+
+		// With no nodes left the board stays at NodeLimit, as a limit of 0
+		// would let the SAT engine run unlimited.
+		bool has_nodes = true;
+		if (sat_limits.max_nodes) {
+			has_nodes = (m_nodes < sat_limits.max_nodes);
+			if (has_nodes)
+				sat_limits.max_nodes -= m_nodes;
+		}
+
+		bool has_time = true;
+		if (sat_limits.max_seconds > 0.0) {
+			sat_limits.max_seconds = std::chrono::duration<double>(m_budget.deadline - std::chrono::steady_clock::now()).count();
+			has_time = (sat_limits.max_seconds > 0.0);
+		}
+
+		if (has_nodes && has_time) {
+			SatSolver sat;
+			has_solved = solve_with(sat, sat_limits);
+		}
+		else if (has_nodes) {
+			m_abortStatus = SSolveStatus::TimedOut;
+		}
+	}
+
+	// An aborted search says nothing about the board, so is not cached.
+	if (m_isAborted) {
+		if (board_ptr) {
+			board_ptr->ClearBoard();
+		}
+		return m_abortStatus;
+	}
+
+	if (board_ptr) {
+		*board_ptr = solved_board;
+	}
+
+	if (m_cache) {
+		char solution[BOARD_SIZE * BOARD_SIZE];
+		if (has_solved)
+			GetBoardAsStringLayout(solved_board, solution);
+		m_cache->Insert(layout, has_solved ? solution : nullptr, steps - start_steps, has_solved);
 	}
 
-	return has_solved;
+	return has_solved ? SSolveStatus::Solved : SSolveStatus::Unsolved;
+}
+
+const char* SudokuSolver::GetStatusName(SSolveStatus status)
+{
+	switch (status) {
+	case SSolveStatus::Solved: return "solved";
+	case SSolveStatus::Unsolved: return "unsolved";
+	case SSolveStatus::TimedOut: return "timeout";
+	case SSolveStatus::NodeLimit: return "nodelimit";
+	case SSolveStatus::Cancelled: return "cancelled";
+	}
+	return "";
 }
 
 bool SudokuSolver::LoadBoardFromStringLayout(SBoard& board, const std::wstring& layout)
@@ -232,6 +708,33 @@ bool SudokuSolver::LoadBoardFromStringLayout(SBoard& board, const std::wstring&
 	return true;
 }
 
+bool SudokuSolver::LoadBoardFromStringLayout(SBoard& board, std::string_view layout)
+{
+	if (layout.size() != BOARD_SIZE * BOARD_SIZE)
+		return false;
+
+	for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+		auto& cell = board.GetCellDirect(i);
+		char c = layout[i];
+
+		if ((c >= '1') && (c <= '9')) {
+			cell.value = static_cast<SValueEnum>(c - '0');
+			cell.state = SStateEnum::SState_Fixed;
+		}
+		else if ((c == '.') || (c == ' ') || (c == '0')) {
+			cell.value = SValueEnum::SValue_Empty;
+			cell.state = SStateEnum::SState_Free;
+		}
+		else {
+			board.UpdateHash();
+			return false;
+		}
+	}
+
+	board.UpdateHash();
+	return true;
+}
+
 std::wstring SudokuSolver::GetBoardAsStringLayout(const SBoard& board)
 {
 	// This does the opposite of LoadBoardFromStringLayout.
@@ -245,3 +748,10 @@ std::wstring SudokuSolver::GetBoardAsStringLayout(const SBoard& board)
 	}
 	return layout;
 }
+
+void SudokuSolver::GetBoardAsStringLayout(const SBoard& board, char* layout)
+{
+	for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+		layout[i] = static_cast<char>('0' + static_cast<int>(board.GetCellDirect(i).value));
+	}
+}
\ No newline at end of file
@@ -7,6 +7,80 @@
 
 #include "SBoard.h"
 #include <string>
+#include <string_view>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class SolutionCache;
+class TranspositionTable;
+
+/**
+ * @brief Outcome of a solve
+ */
+enum class SSolveStatus {
+    Solved,
+    Unsolved,       // the board has no solution
+    TimedOut,       // the time limit was reached first
+    NodeLimit,      // the node limit was reached first
+    Cancelled       // the cancel token was set
+};
+
+/**
+ * @brief Outcome of a pass of `SudokuSolver::Eliminate()`
+ */
+enum class SEliminationResult {
+    NoChange,
+    Progress,           // at least one cell was solved
+    Contradiction       // the board has no solution
+};
+
+/**
+ * @brief Search engine used by `SudokuSolver::Solve()`
+ */
+enum class SSolverEngine {
+    Cells,          // elimination and recursion over `SBoard` cells
+    Bitboard,       // digit planes, see `BitboardSolver`
+    Sat             // clause learning, see `SatSolver`
+};
+
+/**
+ * @brief Order in which `SudokuSolver::SolveBoardByRecursion()` tries the values of a cell
+ */
+enum class SValueOrder {
+    Random,                 // shuffled at each node
+    LeastConstraining       // fewest free peers left without a candidate first, deterministic
+};
+
+/**
+ * @brief Budgets for a single solve. Zero means no limit.
+ */
+struct SSolveLimits
+{
+    double max_seconds = 0.0;                       // wall time
+    uint64_t max_nodes = 0;                         // search nodes (recursion steps)
+    const std::atomic<bool>* cancel = nullptr;      // set from any thread to abort (not owned)
+
+    bool HasLimits() const { return (max_seconds > 0.0) || (max_nodes != 0) || (cancel != nullptr); }
+};
+
+/**
+ * @brief The budget of a solve in progress, as set by `SSolveLimits`
+ */
+struct SSolveBudget
+{
+    SSolveLimits limits;
+    std::chrono::steady_clock::time_point deadline;
+
+    void Start(const SSolveLimits& solve_limits);
+
+    /**
+     * @brief Checks the budget after the given number of search nodes
+     * @param status Receives the reason, if the budget is spent
+     * @return True if the search must stop
+     */
+    bool IsSpent(uint64_t nodes, SSolveStatus& status) const;
+};
 
 /**
  * @class SudokuSolver
@@ -16,8 +90,101 @@ class SudokuSolver
 {
 public:
 
+    /**
+     * @brief Solves a Sudoku board, by elimination first and then by recursion
+     * @param board The Sudoku board to solve. It is not changed.
+     * @param board_ptr Receives the solved board (optional)
+     * @param steps The number of steps taken to solve the board
+     * @return True if the board is solved, false otherwise
+     *
+     * If a solution cache has been set, repeated layouts are answered from the
+     * cache without solving, with the same result as the original solve.
+     */
     bool Solve(SBoard& board, SBoard* board_ptr, int& steps);
 
+    /**
+     * @brief As above, but reports why a board was not solved
+     *
+     * The search stops as soon as any of the limits set by `SetLimits()` is
+     * reached. The steps and `GetNodeCount()` then hold the work done so far,
+     * and the solved board (if requested) is left empty.
+     */
+    SSolveStatus SolveWithStatus(SBoard& board, SBoard* board_ptr, int& steps);
+
+    /**
+     * @brief Sets the budgets applied to each `Solve()`. The default is no limits.
+     */
+    void SetLimits(const SSolveLimits& limits) { m_limits = limits; }
+
+    const SSolveLimits& GetLimits() const { return m_limits; }
+
+    /**
+     * @brief Sets the engine used by `Solve()`. The default is `SSolverEngine::Cells`.
+     *
+     * The bitboard and SAT engines do not use the transposition table. The
+     * solution cache and the limits apply to all.
+     */
+    void SetEngine(SSolverEngine engine) { m_engine = engine; }
+
+    SSolverEngine GetEngine() const { return m_engine; }
+
+    /**
+     * @brief Hands boards that take more than this many search nodes to the SAT engine
+     *
+     * This caps the time spent on boards that are hard for a backtracking
+     * search. The SAT engine continues with what is left of the limits, and
+     * its nodes are added to `GetNodeCount()`. Zero (the default) disables it.
+     */
+    void SetSatFallback(uint64_t max_nodes) { m_satFallbackNodes = max_nodes; }
+
+    uint64_t GetSatFallback() const { return m_satFallbackNodes; }
+
+    /**
+     * @brief Sets the look-ahead of `SolveBoardByRecursion()`, before each guess
+     * @param max_candidates Cells with up to this many candidates are probed
+     *                       (see `Probe()`), typically 2 or 3. Zero (the
+     *                       default) disables the look-ahead.
+     *
+     * Probing trades time per node for fewer nodes. It only applies to the
+     * cells engine.
+     */
+    void SetProbing(int max_candidates) { m_probeCandidates = max_candidates; }
+
+    int GetProbing() const { return m_probeCandidates; }
+
+    /**
+     * @brief Sets the order in which `SolveBoardByRecursion()` tries values
+     *
+     * The default is a random order, so that existing callers keep the search
+     * they have always had. Grids are made by `GridGenerator`, which does not
+     * depend on it. `SValueOrder::LeastConstraining` gives the same search, and
+     * the same solution, on every run. It only applies to the cells engine.
+     */
+    void SetValueOrder(SValueOrder order) { m_valueOrder = order; }
+
+    SValueOrder GetValueOrder() const { return m_valueOrder; }
+
+    /**
+     * @brief Number of search nodes visited by the last solve
+     */
+    uint64_t GetNodeCount() const { return m_nodes; }
+
+    static const char* GetStatusName(SSolveStatus status);
+
+    /**
+     * @brief Sets the cache consulted by `Solve()`
+     * @param cache The cache to use, or nullptr to disable. It is not owned by
+     *              the solver and may be shared between solvers on other threads.
+     */
+    void SetSolutionCache(SolutionCache* cache) { m_cache = cache; }
+
+    /**
+     * @brief Sets the table of boards known to have no solution, used by `SolveBoardByRecursion()`
+     * @param table The table to use, or nullptr to disable. It is not owned by
+     *              the solver and may be shared between solvers on other threads.
+     */
+    void SetTranspositionTable(TranspositionTable* table) { m_table = table; }
+
     /**
      * @brief Reverse solves a Sudoku puzzle by removing values from solved cells
      * @param board The Sudoku board to reverse solve
@@ -32,6 +199,33 @@ public:
      */
     bool FindByElimination(SBoard& board);
 
+    /**
+     * @brief As above, but also reports a board that cannot be solved
+     *
+     * The board has no solution if a free cell has no candidates left, if a
+     * value has no place left in a row, column or block, or if two of the
+     * values found in the pass clash. The pass stops as soon as any of these
+     * is found, so the board may then be partly updated.
+     */
+    SEliminationResult Eliminate(SBoard& board);
+
+    /**
+     * @brief Looks ahead by placing each candidate of the cells with few candidates
+     *
+     * Candidates that lead to a contradiction, through naked and hidden singles,
+     * are ruled out, as are values of other cells that are ruled out whichever
+     * candidate the cell takes. The values found are placed on the board, as
+     * solved. The probes run on copies of a small candidate grid on the stack,
+     * so no boards are allocated.
+     *
+     * Cells with up to the number of candidates set by `SetProbing()` are
+     * probed, or all free cells if probing is not enabled.
+     *
+     * @return Progress if any value was placed, Contradiction if the board has
+     *         no solution. The board is not changed on a contradiction.
+     */
+    SEliminationResult Probe(SBoard& board);
+
     /**
      * @brief Solves a Sudoku board by elimination
      * @param board The Sudoku board to solve
@@ -42,6 +236,12 @@ public:
 
     /**
      * @brief Solves a Sudoku board by recursion
+     *
+     * Starts a new solve, with the budget of `SetLimits()`, and searches it
+     * with `SearchBoard()`. Unlike `SolveWithStatus()`, neither the cache nor
+     * the SAT fallback is used. `GetNodeCount()` then counts this search, and
+     * a spent budget returns false.
+     *
      * @param board The Sudoku board to solve
      * @param pBoard Pointer to the solved board (optional)
      * @param steps The number of steps taken to solve the board
@@ -61,6 +261,18 @@ public:
     */
     bool LoadBoardFromStringLayout(SBoard& board, const std::wstring& layout);
 
+    /**
+     * @brief Narrow character version of the above, for batch input
+     *
+     * The layout is validated while it is loaded, without any allocation. Unlike
+     * the wide version, characters other than '1' - '9' and the empty cell
+     * markers are rejected.
+     *
+     * @return False if the layout is not 81 valid characters. The board is then
+     *         only partly loaded.
+     */
+    bool LoadBoardFromStringLayout(SBoard& board, std::string_view layout);
+
 
     /**
      * @brief Converts the Sudoku board to a string layout
@@ -68,4 +280,38 @@ public:
      * @return The string representation of the Sudoku board layout
      */
     std::wstring GetBoardAsStringLayout(const SBoard& board);
+
+    /**
+     * @brief Writes the board layout into the caller's buffer, without allocating
+     * @param board The Sudoku board to convert
+     * @param layout Receives 81 characters, '0' for empty cells. No terminator is written.
+     */
+    void GetBoardAsStringLayout(const SBoard& board, char* layout);
+
+protected:
+
+    /**
+     * @brief The recursion of `SolveBoardByRecursion()`, within the current solve
+     *
+     * Each call is a search node, counted against the budget of the current
+     * solve. Once the budget is spent every call returns false. Branches are
+     * abandoned as soon as `Eliminate()` finds a contradiction. With a
+     * transposition table, boards found to have no solution are added to it,
+     * both as given and after elimination, and skipped when met again.
+     */
+    bool SearchBoard(SBoard board, SBoard* pBoard, int& steps);
+
+    SolutionCache* m_cache = nullptr;
+    TranspositionTable* m_table = nullptr;
+    SSolveLimits m_limits;
+    SSolverEngine m_engine = SSolverEngine::Cells;
+    uint64_t m_satFallbackNodes = 0;
+    int m_probeCandidates = 0;
+    SValueOrder m_valueOrder = SValueOrder::Random;
+
+    // State of the current solve
+    SSolveBudget m_budget;
+    SSolveStatus m_abortStatus = SSolveStatus::Unsolved;
+    bool m_isAborted = false;
+    uint64_t m_nodes = 0;
 };
@@ -0,0 +1,60 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(size_t size_bytes /*= DEFAULT_SIZE*/)
+{
+	size_t count = 1;
+	while (count * 2 * sizeof(Bucket) <= size_bytes)
+		count *= 2;
+
+	m_buckets.reset(new Bucket[count]);
+	m_bucketMask = count - 1;
+	Clear();
+}
+
+void TranspositionTable::Clear()
+{
+	for (size_t i = 0; i <= m_bucketMask; i++) {
+		for (auto& key : m_buckets[i].keys) {
+			key.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+bool TranspositionTable::IsDead(uint64_t hash) const
+{
+	uint64_t key = GetKey(hash);
+	const auto& bucket = m_buckets[hash & m_bucketMask];
+	for (const auto& entry : bucket.keys) {
+		uint64_t current = entry.load(std::memory_order_relaxed);
+		if (current == key)
+			return true;
+		if (current == 0)
+			return false;
+	}
+	return false;
+}
+
+/*
+* Fills the bucket in order, so a lookup can stop at the first empty entry.
+* Each entry is a single atomic word, so no ordering with other memory is needed.
+*/
+void TranspositionTable::AddDead(uint64_t hash)
+{
+	uint64_t key = GetKey(hash);
+	auto& bucket = m_buckets[hash & m_bucketMask];
+	for (auto& entry : bucket.keys) {
+		uint64_t current = entry.load(std::memory_order_relaxed);
+		if ((current == 0) && entry.compare_exchange_strong(current, key, std::memory_order_relaxed))
+			return;
+		if (current == key)
+			return;
+	}
+
+	// The bucket is full. The top bits of the hash are not used for the index.
+	bucket.keys[hash >> 61].store(key, std::memory_order_relaxed);
+}
@@ -0,0 +1,74 @@
+/*
+*  Auther: Richard Chin
+*  Date  : May 2024
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class TranspositionTable
+ * @brief A fixed size set of board hashes (`SBoard::GetHash()`) known to have no solution
+ *
+ * Different guesses often lead to the same board once elimination has run,
+ * and the search would otherwise explore it again each time. A board with no
+ * solution has none whichever puzzle it came from, so the table can be kept
+ * between solves.
+ *
+ * Hashes are kept in buckets of eight, one cache line each. Lookups and
+ * inserts are lock free, so one table can be shared by all the threads of a
+ * parallel search. When a bucket is full, an entry chosen by the hash is
+ * replaced, so the table never grows past the size it was made with.
+ *
+ * The full 64-bit hash is compared. Two boards with the same hash would make
+ * the search skip a solvable board, but at these table sizes the odds of this
+ * are far below those of a hardware fault.
+ */
+class TranspositionTable
+{
+public:
+
+    static constexpr size_t DEFAULT_SIZE = 16 * 1024 * 1024;
+
+    /**
+     * @param size_bytes Memory to use, rounded down to a power of two (at least one bucket)
+     */
+    explicit TranspositionTable(size_t size_bytes = DEFAULT_SIZE);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    /**
+     * @brief Forgets every board. Must not be called during a search.
+     */
+    void Clear();
+
+    bool IsDead(uint64_t hash) const;
+
+    void AddDead(uint64_t hash);
+
+    /**
+     * @brief Number of hashes the table can hold
+     */
+    size_t GetCapacity() const { return (m_bucketMask + 1) * BUCKET_SIZE; }
+
+    size_t GetSizeBytes() const { return (m_bucketMask + 1) * sizeof(Bucket); }
+
+protected:
+
+    static constexpr int BUCKET_SIZE = 8;
+
+    struct alignas(64) Bucket {
+        std::atomic<uint64_t> keys[BUCKET_SIZE];    // 0 for an empty entry
+    };
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_bucketMask = 0;
+
+    // The low bit is always set, so no key is 0.
+    static uint64_t GetKey(uint64_t hash) { return hash | 1; }
+};
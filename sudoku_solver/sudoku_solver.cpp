@@ -11,11 +11,28 @@
 #include <cassert>
 #include <map>
 #include <set>
+#include <numeric>
 #include "ConsoleIO.h"
 #include "SudokuSolver.h"
+#include "SolutionCache.h"
+#include "SolverService.h"
+#include "SolverDaemon.h"
+#include "SharedRing.h"
+#include "ParallelSolver.h"
+#include "BatchRunner.h"
+#include "ShardCoordinator.h"
+#include "SolutionVerifier.h"
+#include "GridGenerator.h"
+#include "PuzzleReducer.h"
+#include "SolutionEnumerator.h"
+#include "CheckpointFile.h"
+#include "TranspositionTable.h"
+#include <thread>
+#include <vector>
 #include "s_timer.h"
 
 #define BUILD_VERSION L"Alpha 0.1.0"
+#define CHECKPOINT_INTERVAL 10.0		// seconds between checkpoints of a long run
 
 #define CELL_COLOUR_FIXED FOREGROUND_WHITE
 #define CELL_COLOUR_SOLVED FOREGROUND_LIGHTYELLOW
@@ -32,6 +49,8 @@ void    PrintHelp();
 void    DisplayBoardToConsole(SBoard &, int indent = 0);
 void    WriteBoardToTextFile(SBoard board, std::wstring filename);
 bool    LoadBoardState(std::wstring source, bool useClipboard = false);
+bool    SaveCheckpoint(const std::wstring& path, const SEnumerationCheckpoint& checkpoint, const std::string& puzzle, uint64_t output_size);
+bool    LoadCheckpoint(const std::wstring& path, SEnumerationCheckpoint& checkpoint, std::string& puzzle, uint64_t& output_size);
 
 
 /*********************************
@@ -49,10 +68,55 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 	bool action_create           = false;			// generate blank template layout
 	bool action_solve            = false;			// solve given board (using file or clipboard)
 	bool action_useclipboarddata = false;			// use data in clipboard as source
+	bool action_service          = false;			// solve puzzles from stdin until closed
+	bool option_flush            = false;			// flush every service response
+	bool action_daemon           = false;			// serve puzzles over a unix domain socket
+	bool action_ring             = false;			// serve puzzles from a shared memory ring
+	bool option_parallel         = false;			// search on all cores when solving
+	bool action_batch            = false;			// solve every puzzle in a file
+	bool option_echo             = false;			// batch output lines are <puzzle>,<solution>
+	bool action_verify           = false;			// check every solution in a file
+	bool action_enumerate        = false;			// list every solution of the board
+	bool option_resume           = false;			// continue a batch or enumeration from its checkpoint
+	bool option_ordered          = false;			// try values in least constraining order, not at random
 	std::wstring param_create    = { L"-c" };		//
 	std::wstring param_solve     = { L"-s" };		//
 	std::wstring param_gen       = { L"-g" };
+	std::wstring param_service   = { L"-p" };
+	std::wstring param_flush     = { L"-f" };
+	std::wstring param_daemon    = { L"-d" };
+	std::wstring param_ring      = { L"-r" };
+	std::wstring param_parallel  = { L"-m" };
+	std::wstring param_batch     = { L"-b" };
+	std::wstring param_echo      = { L"-e" };
+	std::wstring param_verify    = { L"-v" };
+	std::wstring param_output    = { L"-o" };
+	std::wstring param_timelimit = { L"-t" };
+	std::wstring param_nodelimit = { L"-n" };
+	std::wstring param_enumerate = { L"-a" };
+	std::wstring param_maxcount  = { L"-l" };
+	std::wstring param_checkpoint = { L"-k" };
+	std::wstring param_resume    = { L"--resume" };
+	std::wstring param_table     = { L"-x" };
+	std::wstring param_engine    = { L"-u" };
+	std::wstring param_fallback  = { L"-q" };
+	std::wstring param_probe     = { L"-w" };
+	std::wstring param_ordered   = { L"-y" };
+	std::wstring param_shard     = { L"--shard" };
+	std::wstring param_shards    = { L"--shards" };
 	std::wstring filename        = { L"" };			//
+	int filename_arg             = 0;				// index of the filename in argv
+	std::wstring output_filename = { L"" };			// batch output, stdout if not given
+	std::wstring checkpoint_filename = { L"" };		// progress of a batch or enumeration, none if not given
+	SSolveLimits limits;							// budgets for each puzzle solved
+	uint64_t max_solutions       = 0;				// solutions listed by -a, 0 for all
+	size_t table_size            = 0;				// bytes of boards with no solution kept by -p and -b, 0 for none
+	SSolverEngine engine         = SSolverEngine::Cells;	// search engine for -s, -p and -b
+	uint64_t sat_fallback        = 0;				// search nodes before a puzzle is handed to the sat engine, 0 for never
+	int probe_candidates         = 0;				// look-ahead on cells with up to this many candidates, 0 for none
+	int shard_index              = 0;				// the slice of the -b input solved by this process
+	int shard_count              = 0;				// slices of the -b input, 0 to solve all of it
+	int shard_processes          = 0;				// -b worker processes to split the input between, 0 for none
 
 	// Loop through all our parameters and set our options variables
 	// NB: The first parameter will be the application filename, so we want to
@@ -62,13 +126,356 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 		bool create = (param_create.compare(argv[n]) == 0);
 		bool solve  = (param_solve.compare(argv[n]) == 0);
 		bool gen = (param_gen.compare(argv[n]) == 0);
+		bool service = (param_service.compare(argv[n]) == 0);
+		bool flush = (param_flush.compare(argv[n]) == 0);
+		bool daemon = (param_daemon.compare(argv[n]) == 0);
+		bool ring = (param_ring.compare(argv[n]) == 0);
+		bool parallel = (param_parallel.compare(argv[n]) == 0);
+		bool batch = (param_batch.compare(argv[n]) == 0);
+		bool echo = (param_echo.compare(argv[n]) == 0);
+		bool verify = (param_verify.compare(argv[n]) == 0);
+		bool enumerate = (param_enumerate.compare(argv[n]) == 0);
+		bool resume = (param_resume.compare(argv[n]) == 0);
+		bool ordered = (param_ordered.compare(argv[n]) == 0);
 		action_create   |= create;
 		action_solve    |= solve;
 		action_generate |= gen;
+		action_service  |= service;
+		option_flush    |= flush;
+		action_daemon   |= daemon;
+		action_ring     |= ring;
+		option_parallel |= parallel;
+		action_batch    |= batch;
+		option_echo     |= echo;
+		action_verify   |= verify;
+		action_enumerate |= enumerate;
+		option_resume   |= resume;
+		option_ordered  |= ordered;
+
+		// The output filename is the parameter following '-o'
+		if ((param_output.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			output_filename = argv[++n];
+			continue;
+		}
+
+		// The solve budgets, in seconds and search nodes
+		if ((param_timelimit.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			limits.max_seconds = std::wcstod(argv[++n], nullptr);
+			continue;
+		}
+		if ((param_nodelimit.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			limits.max_nodes = std::wcstoull(argv[++n], nullptr, 10);
+			continue;
+		}
+
+		// The checkpoint filename is the parameter following '-k'
+		if ((param_checkpoint.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			checkpoint_filename = argv[++n];
+			continue;
+		}
+
+		// The size of the transposition table, in MB
+		if ((param_table.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			table_size = static_cast<size_t>(std::wcstoull(argv[++n], nullptr, 10)) * 1024 * 1024;
+			continue;
+		}
+
+		// The search engine, by name
+		if ((param_engine.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			std::wstring name = argv[++n];
+			if (name == L"bits") {
+				engine = SSolverEngine::Bitboard;
+			}
+			else if (name == L"cells") {
+				engine = SSolverEngine::Cells;
+			}
+			else if (name == L"sat") {
+				engine = SSolverEngine::Sat;
+			}
+			else {
+				std::wcerr << L"# Unknown engine " << name << L" (use cells, bits or sat)" << std::endl;
+				return 1;
+			}
+			continue;
+		}
+
+		// The search nodes before handing over to the sat engine
+		if ((param_fallback.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			sat_fallback = std::wcstoull(argv[++n], nullptr, 10);
+			continue;
+		}
+
+		// The look-ahead before each guess
+		if ((param_probe.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			probe_candidates = static_cast<int>(std::wcstol(argv[++n], nullptr, 10));
+			continue;
+		}
+
+		// The slice of the input to solve, as <index>/<count>
+		if ((param_shard.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			std::wstring shard = argv[++n];
+			if (!BatchRunner::ParseShard(std::filesystem::path(shard).string(), shard_index, shard_count)) {
+				std::wcerr << L"# Invalid shard " << shard << L" (use <index>/<count>, from 0/<count>)" << std::endl;
+				return 1;
+			}
+			continue;
+		}
+
+		// The worker processes to split the input between
+		if ((param_shards.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			shard_processes = static_cast<int>(std::wcstol(argv[++n], nullptr, 10));
+			continue;
+		}
+
+		// The most solutions to list
+		if ((param_maxcount.compare(argv[n]) == 0) && (n + 1 < argc)) {
+			max_solutions = std::wcstoull(argv[++n], nullptr, 10);
+			continue;
+		}
 
-		if (!create && !solve && !gen) {
+		if (!create && !solve && !gen && !service && !flush && !daemon && !ring && !parallel && !batch && !echo && !verify && !enumerate && !resume && !ordered) {
 			filename = argv[n];
+			filename_arg = n;
+		}
+	}
+
+	// Service mode keeps running until stdin is closed. Nothing but the
+	// responses are written to stdout.
+	if (action_service) {
+		std::ios::sync_with_stdio(false);
+
+		SolutionCache cache;
+		SolverService service;
+		service.SetSolutionCache(&cache);
+
+		std::unique_ptr<TranspositionTable> table;
+		if (table_size) {
+			table = std::make_unique<TranspositionTable>(table_size);
+			service.SetTranspositionTable(table.get());
+		}
+		service.SetFlushEachResponse(option_flush);
+		service.SetLimits(limits);
+		service.SetEngine(engine);
+		service.SetSatFallback(sat_fallback);
+		service.SetProbing(probe_candidates);
+		service.SetValueOrder(option_ordered ? SValueOrder::LeastConstraining : SValueOrder::Random);
+		service.Run(std::cin, std::cout);
+		return 0;
+	}
+
+	// Daemon mode serves the same protocol to any number of local clients,
+	// until the process is closed.
+	if (action_daemon) {
+		if (filename.empty())
+			filename = L"ssolve.sock";
+
+		SDaemonOptions options;
+		options.socket_path = std::filesystem::path(filename).string();
+		options.limits = limits;
+
+		SolverDaemon daemon(options);
+		if (!daemon.Start()) {
+			std::wcerr << L"# Failed to listen on " << filename << std::endl;
+			return 1;
+		}
+
+		std::wcout << L"Listening on " << filename << std::endl;
+		daemon.Wait();
+		return 0;
+	}
+
+	// Ring mode attaches solver workers to a ring created by the producer,
+	// until the producer shuts it down.
+	if (action_ring) {
+		SharedRing ring;
+		if (!ring.Open(std::filesystem::path(filename).string())) {
+			std::wcerr << L"# Failed to open ring " << filename << std::endl;
+			return 1;
+		}
+
+		std::vector<std::thread> workers;
+		int worker_count = static_cast<int>(std::thread::hardware_concurrency());
+		if (worker_count < 1)
+			worker_count = 1;
+		for (int i = 0; i < worker_count; i++) {
+			workers.emplace_back([&ring, &limits] { ring.RunWorker(limits); });
+		}
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		return 0;
+	}
+
+	// Sharded batch mode runs this program once per slice of the input file,
+	// as worker processes, and joins their output. The workers are given the
+	// same options, less those the coordinator sets for each.
+	if (action_batch && (shard_processes > 0)) {
+		if (filename.empty() || (shard_processes > ShardCoordinator::MaxShards)) {
+			std::wcerr << L"# --shards needs an input file, and at most " << ShardCoordinator::MaxShards << L" workers" << std::endl;
+			return 1;
+		}
+
+		SShardOptions options;
+		options.program = argv[0];
+		options.input_path = std::filesystem::path(filename).string();
+		options.output_path = std::filesystem::path(output_filename).string();
+		options.count = shard_processes;
+		options.resume = option_resume;
+		for (int n = 1; n < argc; n++) {
+			if ((param_shards.compare(argv[n]) == 0) || (param_output.compare(argv[n]) == 0) || (param_checkpoint.compare(argv[n]) == 0)) {
+				n++;
+				continue;
+			}
+			if ((param_resume.compare(argv[n]) != 0) && (n != filename_arg))
+				options.arguments.push_back(argv[n]);
+		}
+
+		timer t;
+		t.start();
+		ShardCoordinator coordinator(options);
+		bool is_ok = coordinator.Run();
+		t.stop();
+
+		if (!is_ok) {
+			std::wcerr << L"# Failed to finish every shard of " << filename << L" (run again with --resume)" << std::endl;
+			return 1;
 		}
+
+		const auto& stats = coordinator.GetStats();
+		std::wcerr << stats.lines << L" puzzles: " << stats.solved << L" solved, " << stats.unsolved << L" unsolved, "
+		           << stats.invalid << L" invalid, " << stats.aborted << L" aborted, in " << t.get_elapsedtime_sec() << L" secs, "
+		           << shard_processes << L" workers, " << coordinator.GetRestartCount() << L" restarted" << std::endl;
+		return 0;
+	}
+
+	// Batch mode solves every puzzle in the input file (or stdin), writing
+	// one line per puzzle to the output file (or stdout).
+	if (action_batch) {
+		SolutionCache cache;
+		BatchRunner runner;
+		runner.SetSolutionCache(&cache);
+
+		std::unique_ptr<TranspositionTable> table;
+		if (table_size) {
+			table = std::make_unique<TranspositionTable>(table_size);
+			runner.SetTranspositionTable(table.get());
+		}
+		runner.SetLimits(limits);
+		runner.SetEngine(engine);
+		runner.SetSatFallback(sat_fallback);
+		runner.SetProbing(probe_candidates);
+		runner.SetValueOrder(option_ordered ? SValueOrder::LeastConstraining : SValueOrder::Random);
+
+		SolutionWriter writer;
+		writer.SetFormat(option_echo ? SOutputFormat::PuzzleAndSolution : SOutputFormat::Solution);
+
+		// A shard solves only its slice of the input file.
+		uint64_t input_size = 0;
+		if (!filename.empty()) {
+			std::error_code ec;
+			input_size = std::filesystem::file_size(filename, ec);
+			if (ec)
+				input_size = 0;
+		}
+		if (shard_count > 0) {
+			if (filename.empty()) {
+				std::wcerr << L"# --shard needs an input file" << std::endl;
+				return 1;
+			}
+
+			uint64_t begin = 0;
+			uint64_t end = 0;
+			BatchRunner::GetShardRange(input_size, shard_index, shard_count, begin, end);
+			runner.SetInputRange(begin, end);
+			input_size = end - begin;
+		}
+
+		// A resumed run picks up the input and output where the checkpoint left them.
+		SBatchCheckpoint checkpoint;
+		if (option_resume) {
+			if (checkpoint_filename.empty() || filename.empty() || !BatchRunner::LoadCheckpoint(std::filesystem::path(checkpoint_filename).string(), checkpoint)) {
+				std::wcerr << L"# Failed to load checkpoint " << checkpoint_filename << L" (needs -k and an input file)" << std::endl;
+				return 1;
+			}
+		}
+
+		// Output files are written through a mapping, sized for the expected output.
+		bool is_open = false;
+		if (output_filename.empty()) {
+			is_open = writer.OpenStdout();
+		}
+		else if (option_resume) {
+			is_open = writer.ResumeFile(std::filesystem::path(output_filename).string(), checkpoint.output_size);
+		}
+		else {
+			size_t initial_size = static_cast<size_t>(input_size) * 2 + SolutionWriter::DEFAULT_BUFFER_SIZE;
+			is_open = writer.OpenMapped(std::filesystem::path(output_filename).string(), initial_size);
+		}
+		if (!is_open) {
+			std::wcerr << L"# Failed to open output " << output_filename << std::endl;
+			return 1;
+		}
+
+		if (!checkpoint_filename.empty()) {
+			runner.SetCheckpoint([path = std::filesystem::path(checkpoint_filename).string()](const SBatchCheckpoint& progress) {
+				return BatchRunner::SaveCheckpoint(path, progress);
+			}, CHECKPOINT_INTERVAL);
+		}
+
+		timer t;
+		t.start();
+		bool is_ok;
+		if (option_resume) {
+			is_ok = runner.Resume(std::filesystem::path(filename).string(), checkpoint, writer);
+		}
+		else {
+			is_ok = filename.empty() ? runner.Run(stdin, writer) : runner.Run(std::filesystem::path(filename).string(), writer);
+		}
+		is_ok &= writer.Close();
+		t.stop();
+
+		// A finished run has nothing to resume. A shard keeps its last checkpoint,
+		// which holds the counts of its slice.
+		if (is_ok && !checkpoint_filename.empty() && (shard_count == 0)) {
+			std::error_code ec;
+			std::filesystem::remove(checkpoint_filename, ec);
+		}
+
+		const auto& stats = runner.GetStats();
+		std::wcerr << stats.lines << L" puzzles: " << stats.solved << L" solved, " << stats.unsolved << L" unsolved, "
+		           << stats.invalid << L" invalid, " << stats.aborted << L" aborted, in " << t.get_elapsedtime_sec() << L" secs" << std::endl;
+		if (!is_ok) {
+			std::wcerr << L"# Failed to read " << filename << L" or write the output" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	// Verify mode checks every <puzzle>,<solution> line of the input file (or
+	// stdin). Only the lines that fail are reported.
+	if (action_verify) {
+		SolutionVerifier verifier;
+		SolutionWriter report;
+		bool is_open = output_filename.empty() ? report.OpenStdout() : report.OpenFile(std::filesystem::path(output_filename).string());
+		if (!is_open) {
+			std::wcerr << L"# Failed to open output " << output_filename << std::endl;
+			return 1;
+		}
+
+		timer t;
+		t.start();
+		bool is_ok = filename.empty() ? verifier.Run(stdin, report) : verifier.Run(std::filesystem::path(filename).string(), report);
+		is_ok &= report.Close();
+		t.stop();
+
+		const auto& stats = verifier.GetStats();
+		std::wcerr << stats.lines << L" lines: " << stats.valid << L" valid, " << stats.invalid << L" invalid, "
+		           << stats.malformed << L" malformed, in " << t.get_elapsedtime_sec() << L" secs" << std::endl;
+		if (!is_ok) {
+			std::wcerr << L"# Failed to read " << filename << L" or write the output" << std::endl;
+			return 1;
+		}
+		return (stats.invalid == 0) ? 0 : 2;
 	}
 
 	// If no filename supplied, use a default.
@@ -79,7 +486,7 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 	else {
 		// if we supplied a filename, but no action options, then just assume we
 		// want to use that file for a solve.
-		if (!action_create && !action_solve && !action_generate) {
+		if (!action_create && !action_solve && !action_generate && !action_enumerate) {
 			action_solve = true;
 		}
 	}
@@ -105,18 +512,22 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 		console.ClearScreen();
 		std::wcout << L"Generating..." << std::endl;
 
-		// Start with a solved board.
-		// It will be initially blank, so no need to use the elimitation process
-		// first.
+		// Start with a solved board, a random transform of a randomly filled
+		// grid. No search is needed.
 		timer t;
 		SBoard board;
 
 		t.start();
-		bool has_solved = solver.SolveBoardByRecursion(SBoard {}, &board, _iteration);
-		assert(has_solved); if (!has_solved) return 1;
+		GridGenerator generator;
+		generator.Generate(board);
+
+		// Remove clues, in a random order, until every clue left is needed.
+		std::vector<int> order(BOARD_SIZE * BOARD_SIZE);
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), std::mt19937(std::random_device{}()));
 
-		//
-		bool has_finished = solver.ReverseSolve(board);
+		PuzzleReducer reducer(option_parallel ? 0 : 1);
+		reducer.Reduce(board, &order);
 
 		// Display to screen
 		t.stop();
@@ -124,6 +535,76 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 		std::wcout << L"Completed in " << t.get_elapsedtime_sec() << L" secs" << std::endl;
 	}
 
+	// Enumerate mode lists every solution of the board, one line each, as they
+	// are found. Nothing is held per solution, so there is no limit to the count.
+	if (action_enumerate) {
+
+		if (!LoadBoardState(filename, action_useclipboarddata)) {
+			std::wcerr << L"# Failed to load board settings" << std::endl;
+			return 1;
+		}
+
+		std::string puzzle(BOARD_SIZE * BOARD_SIZE, '0');
+		solver.GetBoardAsStringLayout(sboard, &puzzle[0]);
+
+		// A resumed run must be of the same board.
+		SEnumerationCheckpoint checkpoint;
+		uint64_t output_size = 0;
+		if (option_resume) {
+			std::string checkpoint_puzzle;
+			if (checkpoint_filename.empty() || !LoadCheckpoint(checkpoint_filename, checkpoint, checkpoint_puzzle, output_size) ||
+				(checkpoint_puzzle != puzzle)) {
+				std::wcerr << L"# Failed to load checkpoint " << checkpoint_filename << L" (needs -k, and the same board)" << std::endl;
+				return 1;
+			}
+		}
+
+		SolutionWriter output;
+		bool is_open = output_filename.empty() ? output.OpenStdout() :
+			option_resume ? output.ResumeFile(std::filesystem::path(output_filename).string(), output_size) :
+			output.OpenFile(std::filesystem::path(output_filename).string());
+		if (!is_open) {
+			std::wcerr << L"# Failed to open output " << output_filename << std::endl;
+			return 1;
+		}
+
+		timer t;
+		t.start();
+
+		SolutionEnumerator enumerator(option_parallel ? 0 : 1);
+		if (!checkpoint_filename.empty()) {
+			// The search is paused while the checkpoint is saved, so the output can be flushed up to it.
+			enumerator.SetCheckpoint([&](const SEnumerationCheckpoint& progress) {
+				return output.Flush() && SaveCheckpoint(checkpoint_filename, progress, puzzle, output.GetBytesWritten());
+			}, CHECKPOINT_INTERVAL);
+		}
+
+		auto write_solution = [&output](const SolutionEnumerator::Grid& solution) {
+			char line[BOARD_SIZE * BOARD_SIZE];
+			for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+				line[i] = static_cast<char>('0' + solution[i]);
+			}
+			return output.WriteLine(std::string_view(line, sizeof(line)));
+		};
+		auto count = option_resume ? enumerator.Resume(checkpoint, write_solution, max_solutions) :
+			enumerator.Enumerate(sboard, write_solution, max_solutions);
+
+		bool is_ok = output.Close();
+		t.stop();
+
+		if (is_ok && !checkpoint_filename.empty()) {
+			std::error_code ec;
+			std::filesystem::remove(checkpoint_filename, ec);
+		}
+
+		std::wcerr << count << L" solutions in " << t.get_elapsedtime_sec() << L" secs" << std::endl;
+		if (!is_ok) {
+			std::wcerr << L"# Failed to write the output" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
 	if (action_solve) {
 
 		{
@@ -143,15 +624,28 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 		SBoard solved_board;
 
 		bool uses_recursion = false;
+		SSolveStatus status = SSolveStatus::Solved;
 		bool has_solved = solver.SolveBoardByElimination(sboard, _iteration);
 
 		if (has_solved) {
 			solved_board = sboard;
 		}
+		else if (option_parallel) {
+			uses_recursion = true;
+			ParallelSolver parallel_solver;
+			parallel_solver.SetLimits(limits);
+			status = parallel_solver.SolveWithStatus(sboard, &solved_board, _iteration);
+		}
 		else {
 			uses_recursion = true;
-			has_solved = solver.SolveBoardByRecursion(sboard, &solved_board, _iteration);
+			solver.SetLimits(limits);
+			solver.SetEngine(engine);
+			solver.SetSatFallback(sat_fallback);
+			solver.SetProbing(probe_candidates);
+			solver.SetValueOrder(option_ordered ? SValueOrder::LeastConstraining : SValueOrder::Random);
+			status = solver.SolveWithStatus(sboard, &solved_board, _iteration);
 		}
+		has_solved = (status == SSolveStatus::Solved);
 
 		t.stop();
 
@@ -190,7 +684,12 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 			CConsoleIO console;
 			console.PushColourAttributes();
 			console.SetColourAttributes(FOREGROUND_LIGHTRED);
-			std::wcerr << L"Failed to solve given board, in ";
+			if (status == SSolveStatus::Unsolved) {
+				std::wcerr << L"Failed to solve given board, in ";
+			}
+			else {
+				std::wcerr << L"Gave up on the board (" << SudokuSolver::GetStatusName(status) << L"), after ";
+			}
 			std::wcout << _iteration << L" attempts";
 			console.PopColourAttributes();
 		}
@@ -359,16 +858,62 @@ void PrintHelp()
 	std::wcout << L"Usage:" << std::endl;
 
 	console.SetColourAttributes(FOREGROUND_LIGHTYELLOW | back_colour);
-	std::wcout << L"  SSolve.exe -g -c -s <filename.txt>" << std::endl << std::endl;
+	std::wcout << L"  SSolve.exe -g -c -s [-m] [-u <engine>] [-q <nodes>] [-w <2|3>] [-y] [-t <secs>] [-n <nodes>] <filename.txt>" << std::endl;
+	std::wcout << L"  SSolve.exe -p [-f] [-u <engine>] [-q <nodes>] [-w <2|3>] [-y] [-x <MB>]" << std::endl;
+	std::wcout << L"  SSolve.exe -d <socket path>" << std::endl;
+	std::wcout << L"  SSolve.exe -r <ring name>" << std::endl;
+	std::wcout << L"  SSolve.exe -b [-e] [-u <engine>] [-q <nodes>] [-w <2|3>] [-y] [-x <MB>] [-o <output.txt>] [-k <checkpoint> [--resume]] [<input.txt>]" << std::endl;
+	std::wcout << L"  SSolve.exe -b [-e] [-u <engine>] [...] [-o <output.txt>] --shards <N> [--resume] <input.txt>" << std::endl;
+	std::wcout << L"  SSolve.exe -b [-e] [-u <engine>] [...] [-o <output.txt>] [-k <checkpoint> [--resume]] --shard <i/N> <input.txt>" << std::endl;
+	std::wcout << L"  SSolve.exe -v [-o <report.txt>] [<input.csv>]" << std::endl;
+	std::wcout << L"  SSolve.exe -a [-m] [-l <max>] [-o <output.txt>] [-k <checkpoint> [--resume]] [<filename.txt>]" << std::endl << std::endl;
 
 	console.SetColourAttributes(FOREGROUND_WHITE | back_colour);
 	std::wcout << L"where:" << std::endl;
 
 	console.SetColourAttributes(FOREGROUND_LIGHTYELLOW | back_colour);
-	std::wcout << L"  -g: Generate a fully valid puzzle" << std::endl;
+	std::wcout << L"  -g: Generate a minimal puzzle, with a unique solution" << std::endl;
 	std::wcout << L"  -c: Create blank board layout to given file/screen" << std::endl;
 	std::wcout << L"  -s: Solve using layout in either file or clipboard" << std::endl;
 	std::wcout << L"      If no input file given, the clipboard data will be used" << std::endl;
+	std::wcout << L"  -m: Search for the solution on all cores (with -s), or reduce on all cores (with -g)" << std::endl;
+	std::wcout << L"  -u: Search engine, cells (the default), bits or sat (with -s, -p, -b)" << std::endl;
+	std::wcout << L"      bits solves on digit planes, much faster on hard puzzles" << std::endl;
+	std::wcout << L"      sat learns from each dead end, for puzzles made to defeat backtracking" << std::endl;
+	std::wcout << L"  -q: Hand a puzzle over to the sat engine after this many search nodes (as -u)" << std::endl;
+	std::wcout << L"  -w: Before each guess, try every value of the cells with up to 2 or 3" << std::endl;
+	std::wcout << L"      candidates, and keep what they all agree on (as -u, cells engine)" << std::endl;
+	std::wcout << L"  -y: Try values in least constraining order rather than at random, so" << std::endl;
+	std::wcout << L"      each run takes the same search (as -w)" << std::endl;
+	std::wcout << L"  -t: Give up on a puzzle after this many seconds (with -s, -p, -d, -r, -b)" << std::endl;
+	std::wcout << L"  -n: Give up on a puzzle after this many search nodes (as -t)" << std::endl;
+	std::wcout << L"  -p: Service mode. Solve puzzles read from stdin, one per line" << std::endl;
+	std::wcout << L"      Lines are <puzzle> or <id>,<puzzle>. Responses are written to stdout" << std::endl;
+	std::wcout << L"      as <id>,<status>,<solution>,<steps>,<microseconds>" << std::endl;
+	std::wcout << L"      Status is solved, unsolved, invalid, or timeout/nodelimit if over budget" << std::endl;
+	std::wcout << L"  -f: Flush each service response as soon as it is written" << std::endl;
+	std::wcout << L"  -x: Remember up to this many MB of boards found to have no solution," << std::endl;
+	std::wcout << L"      and skip them in later searches (with -p, -b)" << std::endl;
+	std::wcout << L"  -d: Daemon mode. Serve the -p protocol on a unix domain socket" << std::endl;
+	std::wcout << L"      to any number of local clients (default ssolve.sock)" << std::endl;
+	std::wcout << L"  -r: Attach solver workers to a shared memory ring created by a producer" << std::endl;
+	std::wcout << L"  -b: Batch mode. Solve every puzzle of the input file (or stdin), writing" << std::endl;
+	std::wcout << L"      one solution line per puzzle to the output file (or stdout)" << std::endl;
+	std::wcout << L"      A first line of column names, as in the test data files, is skipped" << std::endl;
+	std::wcout << L"  -e: Batch output lines are <puzzle>,<solution>" << std::endl;
+	std::wcout << L"  -v: Verify mode. Check every <puzzle>,<solution> line of the input file" << std::endl;
+	std::wcout << L"      (or stdin), reporting <line>,<reason> for each line that fails" << std::endl;
+	std::wcout << L"  -a: List every solution of the board in the file (or clipboard), one per line" << std::endl;
+	std::wcout << L"      to the output file (or stdout). Searches on all cores with -m" << std::endl;
+	std::wcout << L"  -l: Stop after listing this many solutions (with -a)" << std::endl;
+	std::wcout << L"  -o: Write the output of -b or -a, or the report of -v, to this file" << std::endl;
+	std::wcout << L"      rather than stdout" << std::endl;
+	std::wcout << L"  -k: Save the progress of -b or -a to this file every 10 secs" << std::endl;
+	std::wcout << L"      --resume: Continue from the saved progress, appending to the output" << std::endl;
+	std::wcout << L"  --shards: Split the input file of -b between this many worker processes," << std::endl;
+	std::wcout << L"      and join their output. A failed worker is restarted from its checkpoint" << std::endl;
+	std::wcout << L"  --shard: Solve only slice i of N of the input file of -b, from 0/N. The outputs" << std::endl;
+	std::wcout << L"      of slices 0 to N-1, joined in order, are the output of the whole file" << std::endl;
 
 	console.PopColourAttributes();
 }
@@ -485,3 +1030,32 @@ bool LoadBoardState(std::wstring source, bool useClipboard /*= false*/)
 
 	return true;
 }
+
+
+/******************************************************************************
+* Checkpoints of enumerate runs. Each is saved with its mode, as are those of
+* batch runs (see BatchRunner), so one cannot be resumed as the other.
+*******************************************************************************/
+bool SaveCheckpoint(const std::wstring& path, const SEnumerationCheckpoint& checkpoint, const std::string& puzzle, uint64_t output_size)
+{
+	CheckpointFile file;
+	file.SetValue("mode", "enumerate");
+	file.SetValue("puzzle", puzzle);
+	file.SetNumber("found", checkpoint.found);
+	file.SetNumber("output_size", output_size);
+	file.GetLines() = checkpoint.frontier;
+	return file.Save(std::filesystem::path(path).string());
+}
+
+bool LoadCheckpoint(const std::wstring& path, SEnumerationCheckpoint& checkpoint, std::string& puzzle, uint64_t& output_size)
+{
+	CheckpointFile file;
+	if (!file.Load(std::filesystem::path(path).string()) || (file.GetValue("mode") != "enumerate"))
+		return false;
+
+	puzzle = file.GetValue("puzzle");
+	output_size = file.GetNumber("output_size");
+	checkpoint.found = file.GetNumber("found");
+	checkpoint.frontier = file.GetLines();
+	return true;
+}
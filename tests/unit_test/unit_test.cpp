@@ -1,11 +1,32 @@
 #include "pch.h"
 #include "CppUnitTest.h"
 #include "../../sudoku_solver/SudokuSolver.h"
+#include "../../sudoku_solver/SBoardSymmetry.h"
+#include "../../sudoku_solver/SolutionCache.h"
+#include "../../sudoku_solver/SolverService.h"
+#include "../../sudoku_solver/SolverDaemon.h"
+#include "../../sudoku_solver/SharedRing.h"
+#include "../../sudoku_solver/SolverSession.h"
+#include "../../sudoku_solver/HintEngine.h"
+#include "../../sudoku_solver/ParallelSolver.h"
+#include "../../sudoku_solver/PuzzleParser.h"
+#include "../../sudoku_solver/BatchRunner.h"
+#include "../../sudoku_solver/SolutionVerifier.h"
+#include "../../sudoku_solver/GridGenerator.h"
+#include "../../sudoku_solver/PuzzleReducer.h"
+#include "../../sudoku_solver/SolutionEnumerator.h"
+#include "../../sudoku_solver/CheckpointFile.h"
+#include "../../sudoku_solver/TranspositionTable.h"
+#include "../../sudoku_solver/BitboardSolver.h"
+#include "../../sudoku_solver/SatSolver.h"
 
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <format>
+#include <filesystem>
+#include <thread>
+#include <set>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -41,6 +62,29 @@ namespace unittest
             Assert::AreEqual(layout3, solver.GetBoardAsStringLayout(board));
         }
 
+        TEST_METHOD(TestNarrowStringLayout)
+        {
+            SBoard board;
+            SudokuSolver solver;
+            std::string layout = "004000900930210500650007023000000010075800040400006007080701090009640052200003100";
+
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string_view(layout)));
+            Assert::AreEqual(std::wstring(layout.begin(), layout.end()), solver.GetBoardAsStringLayout(board));
+            Assert::IsTrue(board.GetCell(2, 0).state == SStateEnum::SState_Fixed);
+            Assert::IsTrue(board.GetCell(0, 0).state == SStateEnum::SState_Free);
+
+            char buffer[BOARD_SIZE * BOARD_SIZE];
+            solver.GetBoardAsStringLayout(board, buffer);
+            Assert::AreEqual(layout, std::string(buffer, sizeof(buffer)));
+
+            // Empty cell markers are accepted, anything else is rejected
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string_view("..4...9. 930210500650007023000000010075800040400006007080701090009640052200003100")));
+            solver.GetBoardAsStringLayout(board, buffer);
+            Assert::AreEqual(layout, std::string(buffer, sizeof(buffer)));
+            Assert::IsFalse(solver.LoadBoardFromStringLayout(board, std::string_view("x04000900930210500650007023000000010075800040400006007080701090009640052200003100")));
+            Assert::IsFalse(solver.LoadBoardFromStringLayout(board, std::string_view("0040009")));
+        }
+
         TEST_METHOD(TestIntermediateSolution)
         {
 			int steps = 0;
@@ -61,6 +105,46 @@ namespace unittest
 
         }
 
+        TEST_METHOD(TestSolutionCache)
+        {
+            int steps = 0;
+            SBoard board;
+            SBoard solved_board;
+            SudokuSolver solver;
+            SolutionCache cache;
+            solver.SetSolutionCache(&cache);
+
+            std::wstring unsolved_layout = L"004000900930210500650007023000000010075800040400006007080701090009640052200003100";
+            std::wstring solved_layout = L"724365981938214576651987423863479215175832649492156837586721394319648752247593168";
+
+            // A miss and a hit give the same result, and leave the board as given
+            for (int i = 0; i < 3; i++) {
+                solver.LoadBoardFromStringLayout(board, unsolved_layout);
+                Assert::IsTrue(solver.Solve(board, &solved_board, steps));
+                Assert::AreEqual(solved_layout, solver.GetBoardAsStringLayout(solved_board));
+                Assert::AreEqual(unsolved_layout, solver.GetBoardAsStringLayout(board));
+                Assert::IsTrue(solved_board.GetCell(0, 0).state != SStateEnum::SState_Fixed);
+                Assert::IsTrue(solved_board.GetCell(2, 0).state == SStateEnum::SState_Fixed);
+                Assert::IsTrue(solved_board.IsBoardSolved());
+
+                SBoard reloaded;
+                solver.LoadBoardFromStringLayout(reloaded, solved_layout);
+                Assert::AreEqual(reloaded.GetHash(), solved_board.GetHash());
+            }
+
+            Assert::AreEqual(uint64_t(1), cache.GetMisses());
+            Assert::AreEqual(uint64_t(2), cache.GetHits());
+
+            // A single entry budget evicts the previous layout.
+            const std::string unsolved = "004000900930210500650007023000000010075800040400006007080701090009640052200003100";
+            const std::string solved = "724365981938214576651987423863479215175832649492156837586721394319648752247593168";
+            SolutionCache small_cache(1, 1);
+            small_cache.Insert(unsolved.c_str(), solved.c_str(), 1, true);
+            small_cache.Insert(solved.c_str(), solved.c_str(), 0, true);
+            Assert::AreEqual(uint64_t(1), small_cache.GetEvictions());
+            Assert::AreEqual(size_t(1), small_cache.GetEntryCount());
+        }
+
         void TestSolutionFromFile(const std::wstring& filename)
         {
             int steps = 0;
@@ -114,4 +198,1594 @@ namespace unittest
             TestSolutionFromFile(LR"(C:\dev\Sudoku-Solver\tests\data\sudoku_tests_expert.csv)");
         }
 	};
+
+	TEST_CLASS(SBoardSymmetryTests)
+	{
+	public:
+        TEST_METHOD(TestCanonicalFormOfEquivalentPuzzles)
+        {
+            SBoard board;
+            SudokuSolver solver;
+            std::wstring layout = L"004000900930210500650007023000000010075800040400006007080701090009640052200003100";
+            solver.LoadBoardFromStringLayout(board, layout);
+
+            // Transpose, swap bands/stacks and rows/columns, and relabel digits.
+            SBoardTransform t;
+            t.transpose = true;
+            t.rows = { 7,6,8,1,0,2,4,5,3 };
+            t.cols = { 3,5,4,8,7,6,0,1,2 };
+            t.digits = { 0,9,8,7,6,5,4,3,2,1 };
+            SBoard equivalent = SBoardSymmetry::Apply(board, t);
+            Assert::AreNotEqual(layout, solver.GetBoardAsStringLayout(equivalent));
+
+            SBoardTransform t1, t2;
+            auto key1 = SBoardSymmetry::GetCanonicalForm(board, t1);
+            auto key2 = SBoardSymmetry::GetCanonicalForm(equivalent, t2);
+            Assert::AreEqual(key1, key2);
+
+            // The returned transform maps the canonical board back to the original.
+            SBoard canonical = SBoardSymmetry::Apply(board, t1);
+            Assert::AreEqual(key1, solver.GetBoardAsStringLayout(canonical));
+            Assert::AreEqual(layout, solver.GetBoardAsStringLayout(SBoardSymmetry::ApplyInverse(canonical, t1)));
+        }
+	};
+
+	// Counts the flushes of an output stream
+	class FlushCountingBuffer : public std::stringbuf
+	{
+	public:
+		int flushes = 0;
+
+	protected:
+		int sync() override
+		{
+			flushes++;
+			return std::stringbuf::sync();
+		}
+	};
+
+	TEST_CLASS(SolverServiceTests)
+	{
+	public:
+        TEST_METHOD(TestRequestsAreParsed)
+        {
+            const std::string puzzle = "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7";
+            SServiceRequest request;
+
+            // A bare puzzle has no id
+            Assert::IsTrue(SolverService::ParseRequest("  " + puzzle + "\r", request));
+            Assert::AreEqual(std::string(), request.id);
+            Assert::AreEqual(puzzle, request.puzzle);
+
+            Assert::IsTrue(SolverService::ParseRequest("job 7 , " + puzzle, request));
+            Assert::AreEqual(std::string("job 7"), request.id);
+            Assert::AreEqual(puzzle, request.puzzle);
+
+            // The puzzle,solution rows of the test data files
+            Assert::IsTrue(SolverService::ParseRequest(puzzle + ",516497832849532671732168459453789126981625743267341598375216984128974365694853217,", request));
+            Assert::AreEqual(std::string(), request.id);
+            Assert::AreEqual(puzzle, request.puzzle);
+
+            // Not a puzzle, but still a request, answered as invalid
+            Assert::IsTrue(SolverService::ParseRequest("b,123", request));
+            Assert::AreEqual(std::string("b"), request.id);
+            Assert::AreEqual(std::string("123"), request.puzzle);
+
+            Assert::IsFalse(SolverService::ParseRequest(" \t\r", request));
+        }
+
+        TEST_METHOD(TestResponsesAreWrittenInOrder)
+        {
+            std::istringstream in(
+                "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7\n"
+                "\n"
+                "b,123\n"
+                "c,11" + std::string(79, '.') + "\n"
+                "d,004000900930210500650007023000000010075800040400006007080701090009640052200003100\n");
+            std::ostringstream out;
+
+            SolverService service;
+            Assert::AreEqual(4, service.Run(in, out));
+
+            std::istringstream responses(out.str());
+            std::string line;
+            std::vector<std::string> lines;
+            while (std::getline(responses, line)) {
+                lines.push_back(line);
+            }
+            Assert::AreEqual(size_t(4), lines.size());
+
+            // Requests without an id are numbered
+            Assert::AreEqual(std::string("1,solved,516497832849532671732168459453789126981625743267341598375216984128974365694853217,"), lines[0].substr(0, 91));
+            Assert::AreEqual(std::string("b,invalid,,0,"), lines[1].substr(0, 13));
+            Assert::AreEqual(std::string("c,invalid,,0,"), lines[2].substr(0, 13));
+            Assert::AreEqual(std::string("d,solved,724365981938214576651987423863479215175832649492156837586721394319648752247593168,"), lines[3].substr(0, 91));
+
+            // <id>,<status>,<solution>,<steps>,<microseconds>
+            for (const auto& response : lines) {
+                Assert::AreEqual(4, static_cast<int>(std::count(response.begin(), response.end(), ',')));
+            }
+        }
+
+        TEST_METHOD(TestResponsesAreFlushedWhenAsked)
+        {
+            const std::string requests =
+                "a,..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7\n"
+                "b,123\n"
+                "c,004000900930210500650007023000000010075800040400006007080701090009640052200003100\n";
+
+            // The input holds every request, so the output is only flushed
+            // once it runs out
+            FlushCountingBuffer batched;
+            {
+                std::istringstream in(requests);
+                std::ostream out(&batched);
+                SolverService service;
+                Assert::AreEqual(3, service.Run(in, out));
+            }
+            Assert::IsTrue(batched.flushes < 3);
+
+            FlushCountingBuffer each;
+            {
+                std::istringstream in(requests);
+                std::ostream out(&each);
+                SolverService service;
+                service.SetFlushEachResponse(true);
+                Assert::AreEqual(3, service.Run(in, out));
+            }
+            Assert::IsTrue(each.flushes >= 3);
+
+            // Either way, every response is written
+            std::string batched_output = batched.str();
+            std::string each_output = each.str();
+            Assert::AreEqual(3, static_cast<int>(std::count(batched_output.begin(), batched_output.end(), '\n')));
+            Assert::AreEqual(3, static_cast<int>(std::count(each_output.begin(), each_output.end(), '\n')));
+        }
+	};
+
+	TEST_CLASS(SolverDaemonTests)
+	{
+	public:
+        TEST_METHOD(TestPipelinedRequestsAreAnsweredInOrder)
+        {
+            SDaemonOptions options;
+            options.socket_path = (std::filesystem::temp_directory_path() / "ssolve_unit_test.sock").string();
+            options.worker_count = 4;
+            options.batch_size = 2;
+
+            SolverDaemon daemon(options);
+            Assert::IsTrue(daemon.Start());
+
+            SolverClient client;
+            Assert::IsTrue(client.Connect(options.socket_path));
+
+            Assert::IsTrue(client.Send("a,004000900930210500650007023000000010075800040400006007080701090009640052200003100"));
+            Assert::IsTrue(client.Send("b,123"));
+            Assert::IsTrue(client.Send("..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7"));
+
+            std::string line;
+            Assert::IsTrue(client.ReadLine(line));
+            Assert::AreEqual(std::string("a,solved,724365981938214576651987423863479215175832649492156837586721394319648752247593168"), line.substr(0, 90));
+            Assert::IsTrue(client.ReadLine(line));
+            Assert::AreEqual(std::string("b,invalid,,"), line.substr(0, 11));
+            Assert::IsTrue(client.ReadLine(line));
+            Assert::AreEqual(std::string("3,solved,516497832849532671732168459453789126981625743267341598375216984128974365694853217"), line.substr(0, 90));
+
+            daemon.Stop();
+            Assert::AreEqual(uint64_t(3), daemon.GetRequestCount());
+        }
+
+        TEST_METHOD(TestClientThatWritesEverythingBeforeReading)
+        {
+            // Far more responses than the socket buffers hold, so the daemon
+            // must keep reading while the client is not
+            const int count = 20000;
+            SDaemonOptions options;
+            options.socket_path = (std::filesystem::temp_directory_path() / "ssolve_unit_test_pipeline.sock").string();
+            options.worker_count = 2;
+            options.queue_capacity = 64;
+
+            SolverDaemon daemon(options);
+            Assert::IsTrue(daemon.Start());
+
+            SolverClient client;
+            Assert::IsTrue(client.Connect(options.socket_path));
+            for (int i = 0; i < count; i++) {
+                Assert::IsTrue(client.Send(std::to_string(i) + ",004000900930210500650007023000000010075800040400006007080701090009640052200003100"));
+            }
+
+            // A second client is still served meanwhile
+            SolverClient other;
+            std::string line;
+            Assert::IsTrue(other.Connect(options.socket_path));
+            Assert::IsTrue(other.Send("x,123"));
+            Assert::IsTrue(other.ReadLine(line));
+            Assert::AreEqual(std::string("x,invalid,,"), line.substr(0, 11));
+
+            for (int i = 0; i < count; i++) {
+                Assert::IsTrue(client.ReadLine(line));
+                Assert::AreEqual(std::to_string(i) + ",solved,", line.substr(0, line.find(',') + 8));
+            }
+
+            daemon.Stop();
+            Assert::AreEqual(uint64_t(count + 1), daemon.GetRequestCount());
+        }
+	};
+
+	TEST_CLASS(SharedRingTests)
+	{
+	public:
+        TEST_METHOD(TestResultsAreReapedInSubmissionOrder)
+        {
+            SharedRing producer;
+            SharedRing worker_ring;
+            Assert::IsTrue(producer.Create("unit_test", 3));
+            Assert::IsTrue(worker_ring.Open("unit_test"));
+            Assert::AreEqual(uint32_t(4), producer.GetCapacity());
+
+            std::thread worker([&worker_ring] { worker_ring.RunWorker(); });
+
+            const char* puzzles[] = {
+                "004000900930210500650007023000000010075800040400006007080701090009640052200003100",
+                "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7",
+                "11..............................................................................."
+            };
+
+            uint64_t submitted = 0;
+            uint64_t reaped = 0;
+            SRingResult result;
+            while (reaped < 9) {
+                if ((submitted < 9) && producer.Submit(puzzles[submitted % 3], submitted)) {
+                    submitted++;
+                }
+                if (producer.Reap(result)) {
+                    Assert::AreEqual(reaped, result.user_data);
+                    if ((reaped % 3) == 2) {
+                        Assert::IsTrue(result.status == SRingStatus::Invalid);
+                    }
+                    else {
+                        Assert::IsTrue(result.status == SRingStatus::Solved);
+                    }
+                    if ((reaped % 3) == 1) {
+                        Assert::AreEqual(std::string("516497832849532671732168459453789126981625743267341598375216984128974365694853217"),
+                                         std::string(result.solution, sizeof(result.solution)));
+                    }
+                    reaped++;
+                }
+            }
+
+            producer.Shutdown();
+            worker.join();
+        }
+	};
+
+	TEST_CLASS(SolverSessionTests)
+	{
+	public:
+        TEST_METHOD(TestIncrementalEditsAndUndo)
+        {
+            SBoard board;
+            SudokuSolver solver;
+            solver.LoadBoardFromStringLayout(board, L"004000900930210500650007023000000010075800040400006007080701090009640052200003100");
+
+            SolverSession session(board);
+            Assert::IsFalse(session.IsContradiction());
+            Assert::IsTrue(session.HasUniqueCompletion());
+
+            // Givens cannot be changed
+            Assert::IsFalse(session.Place(SPos(2, 0), SValueEnum::SValue_1));
+
+            // Row 0 holds 4 and 9, column 0 holds 9, 6, 4 and 2, block 0 holds 9, 3, 6 and 5
+            Assert::AreEqual(uint16_t((1 << 0) | (1 << 6) | (1 << 7)), session.Candidates(SPos(0, 0)));
+
+            // Clashes with the 4 in the same row
+            Assert::IsTrue(session.Place(SPos(0, 0), SValueEnum::SValue_4));
+            Assert::IsTrue(session.IsContradiction());
+            Assert::IsTrue(session.Undo());
+            Assert::IsFalse(session.IsContradiction());
+
+            // Locally valid, but not the solution (7)
+            Assert::IsTrue(session.Place(SPos(0, 0), SValueEnum::SValue_8));
+            Assert::IsFalse(session.HasUniqueCompletion());
+            Assert::IsTrue(session.Place(SPos(0, 0), SValueEnum::SValue_7));
+            Assert::IsTrue(session.HasUniqueCompletion());
+            Assert::AreEqual(size_t(2), session.GetUndoDepth());
+
+            Assert::IsTrue(session.Clear(SPos(0, 0)));
+            Assert::AreEqual(uint16_t((1 << 0) | (1 << 6) | (1 << 7)), session.Candidates(SPos(0, 0)));
+
+            // A candidate ruled out stays out until undone, whatever its peers hold
+            Assert::IsTrue(session.Eliminate(SPos(0, 0), SValueEnum::SValue_8));
+            Assert::IsFalse(session.Eliminate(SPos(0, 0), SValueEnum::SValue_8));
+            Assert::IsFalse(session.Eliminate(SPos(0, 0), SValueEnum::SValue_4));
+            Assert::AreEqual(uint16_t((1 << 0) | (1 << 6)), session.Candidates(SPos(0, 0)));
+            Assert::IsTrue(session.Place(SPos(1, 0), SValueEnum::SValue_8));
+            Assert::IsTrue(session.Clear(SPos(1, 0)));
+            Assert::AreEqual(uint16_t((1 << 0) | (1 << 6)), session.Candidates(SPos(0, 0)));
+
+            // Ruling out the last candidates leaves no completion
+            Assert::IsTrue(session.Eliminate(SPos(0, 0), SValueEnum::SValue_7));
+            Assert::IsFalse(session.HasUniqueCompletion());
+            Assert::IsTrue(session.Eliminate(SPos(0, 0), SValueEnum::SValue_1));
+            Assert::IsTrue(session.IsContradiction());
+
+            for (int i = 0; i < 5; i++) {
+                Assert::IsTrue(session.Undo());
+            }
+            Assert::IsFalse(session.IsContradiction());
+            Assert::AreEqual(uint16_t((1 << 0) | (1 << 6) | (1 << 7)), session.Candidates(SPos(0, 0)));
+            Assert::IsTrue(session.HasUniqueCompletion());
+        }
+	};
+
+	TEST_CLASS(HintEngineTests)
+	{
+	public:
+        TEST_METHOD(TestHintsFollowTheSolution)
+        {
+            const std::wstring solution = L"724365981938214576651987423863479215175832649492156837586721394319648752247593168";
+
+            SBoard board;
+            SudokuSolver solver;
+            solver.LoadBoardFromStringLayout(board, L"004000900930210500650007023000000010075800040400006007080701090009640052200003100");
+
+            HintEngine engine;
+            SolverSession session(board);
+            SHint hint;
+            while (engine.FindHint(session, hint)) {
+                Assert::IsTrue(hint.technique != SHintTechnique::None);
+                Assert::IsFalse(hint.units.empty());
+
+                for (const auto& elimination : hint.eliminations) {
+                    int expected = solution[elimination.first.row * BOARD_SIZE + elimination.first.col] - L'0';
+                    Assert::AreNotEqual(expected, static_cast<int>(elimination.second));
+                }
+                if (!hint.eliminations.empty())
+                    break;
+
+                int expected = solution[hint.position.row * BOARD_SIZE + hint.position.col] - L'0';
+                Assert::AreEqual(expected, static_cast<int>(hint.value));
+                Assert::IsTrue(session.Place(hint.position, hint.value));
+            }
+
+            // Singles alone are enough for this board
+            Assert::AreEqual(solution, solver.GetBoardAsStringLayout(session.GetBoard()));
+
+            // The board overload gives the same first hint as the session
+            SHint first;
+            Assert::IsTrue(engine.FindHint(board, first));
+            Assert::IsTrue(first.technique == SHintTechnique::HiddenSingleBlock);
+
+            // No hints for a board with clashing values
+            board.SetCell(0, 0, SCell(SValueEnum::SValue_4, SStateEnum::SState_New));
+            Assert::IsFalse(engine.FindHint(board, hint));
+        }
+
+        TEST_METHOD(TestEliminationHintsCanBeApplied)
+        {
+            // Needs pointing, claiming or pair eliminations before singles go on
+            const std::wstring solution = L"489726315126853479357491268594637182261589743873142956712365894638974521945218637";
+
+            SBoard board;
+            SudokuSolver solver;
+            solver.LoadBoardFromStringLayout(board, L"4.97.6.................1268.946...8.26..8..43.7...295.7123.................2.86.7");
+
+            HintEngine engine;
+            SolverSession session(board);
+            SHint hint;
+            int elimination_hints = 0;
+            int singles_after_eliminations = 0;
+            while (engine.FindHint(session, hint)) {
+                if (!hint.eliminations.empty()) {
+                    for (const auto& elimination : hint.eliminations) {
+                        int expected = solution[elimination.first.row * BOARD_SIZE + elimination.first.col] - L'0';
+                        Assert::AreNotEqual(expected, static_cast<int>(elimination.second));
+                        Assert::IsTrue(session.Eliminate(elimination.first, elimination.second));
+                    }
+                    elimination_hints++;
+                    continue;
+                }
+
+                int expected = solution[hint.position.row * BOARD_SIZE + hint.position.col] - L'0';
+                Assert::AreEqual(expected, static_cast<int>(hint.value));
+                Assert::IsTrue(session.Place(hint.position, hint.value));
+                if (elimination_hints > 0)
+                    singles_after_eliminations++;
+            }
+
+            Assert::IsTrue(elimination_hints > 0);
+            Assert::IsTrue(singles_after_eliminations > 0);
+            Assert::AreEqual(solution, solver.GetBoardAsStringLayout(session.GetBoard()));
+        }
+	};
+
+	TEST_CLASS(ParallelSolverTests)
+	{
+	public:
+        TEST_METHOD(TestParallelSolveMatchesExpected)
+        {
+            const std::wstring puzzles[][2] = {
+                { L"..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7",
+                  L"516497832849532671732168459453789126981625743267341598375216984128974365694853217" },
+                { L"7....3.24..9.4.....1..7......5...6...3.687.4...6...2......6..8.....5.1..59.2....6",
+                  L"768513924359842761214976853975421638132687549846395217427169385683754192591238476" },
+            };
+
+            SudokuSolver solver;
+            ParallelSolver parallel_solver(4);
+            Assert::AreEqual(4, parallel_solver.GetThreadCount());
+
+            // The pool is reused between solves
+            for (int repeat = 0; repeat < 3; repeat++) {
+                for (const auto& puzzle : puzzles) {
+                    SBoard board;
+                    SBoard board_solved;
+                    int steps = 0;
+                    solver.LoadBoardFromStringLayout(board, puzzle[0]);
+
+                    Assert::IsTrue(parallel_solver.Solve(board, &board_solved, steps));
+                    Assert::AreEqual(puzzle[1], solver.GetBoardAsStringLayout(board_solved));
+                    Assert::IsTrue(steps > 0);
+                }
+            }
+        }
+	};
+
+	TEST_CLASS(PuzzleParserTests)
+	{
+	public:
+        TEST_METHOD(TestParseMasksAndErrors)
+        {
+            const std::string line = "..4...9..930210500650007023000000010075800040400006007080701090009640052200003100";
+
+            SParsedPuzzle puzzle;
+            SParsedPuzzle scalar;
+            Assert::IsTrue(PuzzleParser::Parse(line, puzzle) == SParseResult::Ok);
+            Assert::IsTrue(PuzzleParser::ParseScalar(line, scalar) == SParseResult::Ok);
+            Assert::IsTrue(std::equal(std::begin(puzzle.values), std::end(puzzle.values), std::begin(scalar.values)));
+
+            // Row 0 holds 4 and 9, column 0 holds 9, 6, 4 and 2, block 0 holds 4, 9, 3, 6 and 5
+            Assert::AreEqual(uint16_t((1 << 3) | (1 << 8)), puzzle.rows[0]);
+            Assert::AreEqual(uint16_t((1 << 8) | (1 << 5) | (1 << 3) | (1 << 1)), puzzle.cols[0]);
+            Assert::AreEqual(uint16_t((1 << 3) | (1 << 8) | (1 << 2) | (1 << 5) | (1 << 4)), puzzle.blocks[0]);
+            Assert::AreEqual(uint8_t(4), puzzle.values[2]);
+            Assert::IsTrue(puzzle.IsGiven(2));
+            Assert::IsFalse(puzzle.IsGiven(0));
+            Assert::IsTrue(puzzle.IsGiven(80 - 2));     // the final 1 is in the 64 - 80 word
+            Assert::AreEqual(0, std::memcmp(puzzle.givens, scalar.givens, sizeof(puzzle.givens)));
+
+            SBoard board;
+            SudokuSolver solver;
+            puzzle.ToBoard(board);
+            Assert::AreEqual(std::wstring(L"004000900930210500650007023000000010075800040400006007080701090009640052200003100"), solver.GetBoardAsStringLayout(board));
+            Assert::IsTrue(board.GetCell(2, 0).state == SStateEnum::SState_Fixed);
+
+            // A second 9 in row 1 (in the last cell of the first SSE block), and a bad character in the tail
+            std::string duplicate = line;
+            duplicate[15] = '9';
+            std::string bad = line;
+            bad[80] = 'x';
+            duplicate[80] = 'x';
+            Assert::IsTrue(PuzzleParser::Parse(line.substr(0, 80), puzzle) == SParseResult::BadLength);
+            Assert::IsTrue(PuzzleParser::Parse(bad, puzzle) == SParseResult::BadCharacter);
+            Assert::IsTrue(PuzzleParser::ParseScalar(bad, puzzle) == SParseResult::BadCharacter);
+            Assert::IsTrue(PuzzleParser::Parse(duplicate, puzzle) == SParseResult::BadCharacter);
+            duplicate[80] = '0';
+            Assert::IsTrue(PuzzleParser::Parse(duplicate, puzzle) == SParseResult::DuplicateGiven);
+            Assert::IsTrue(PuzzleParser::ParseScalar(duplicate, puzzle) == SParseResult::DuplicateGiven);
+        }
+	};
+
+	// Swaps out the file handle of a mapped writer, so that growing the
+	// mapping fails
+	class BrokenMappingWriter : public SolutionWriter
+	{
+	public:
+		using SolutionWriter::SolutionWriter;
+
+		intptr_t BreakFile()
+		{
+			intptr_t handle = m_fileHandle;
+#ifdef _WIN32
+			m_fileHandle = 0;
+#else
+			m_fileHandle = -1;
+#endif
+			return handle;
+		}
+
+		void RestoreFile(intptr_t handle) { m_fileHandle = handle; }
+	};
+
+	TEST_CLASS(BatchRunnerTests)
+	{
+	public:
+        TEST_METHOD(TestFailedMappingGrowthKeepsTheOutput)
+        {
+            const std::string solution = "516497832849532671732168459453789126981625743267341598375216984128974365694853217";
+            auto path = (std::filesystem::temp_directory_path() / "ssolve_mapped_test.txt").string();
+
+            BrokenMappingWriter writer;
+            Assert::IsTrue(writer.OpenMapped(path, 200));
+            Assert::IsTrue(writer.Write({}, solution.c_str()));
+            Assert::IsTrue(writer.Write({}, solution.c_str()));
+
+            // The third line does not fit, and the mapping cannot grow
+            intptr_t handle = writer.BreakFile();
+            Assert::IsFalse(writer.Write({}, solution.c_str()));
+            writer.RestoreFile(handle);
+            Assert::AreEqual(uint64_t(2 * 82), writer.GetBytesWritten());
+            Assert::IsFalse(writer.Close());
+
+            // The lines before the failure are kept, so the run can be resumed
+            {
+                std::ifstream file(path, std::ios::binary);
+                Assert::AreEqual(solution + "\n" + solution + "\n",
+                    std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+            }
+            Assert::IsTrue(writer.ResumeFile(path, 2 * 82));
+            Assert::IsTrue(writer.Close());
+
+            std::filesystem::remove(path);
+        }
+
+        TEST_METHOD(TestBatchOutputToFileAndMapping)
+        {
+            const std::string input =
+                "quizzes,solutions\r\n"
+                "041032080070005000905107640200700009000040850006009300018624900009000000052003700,641932587873465291925187643234758169197346852586219374718624935369571428452893716\r\n"
+                "\r\n"
+                "a,..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7\n"
+                "b,116.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7";
+            // The header is skipped, rather than written as an invalid puzzle
+            const std::string expected =
+                "041032080070005000905107640200700009000040850006009300018624900009000000052003700,641932587873465291925187643234758169197346852586219374718624935369571428452893716\n"
+                "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7,516497832849532671732168459453789126981625743267341598375216984128974365694853217\n"
+                "116.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7,\n";
+
+            auto path = (std::filesystem::temp_directory_path() / "ssolve_batch_test.txt").string();
+            auto read_output = [&path]() {
+                std::ifstream file(path, std::ios::binary);
+                return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            };
+
+            for (int sink = 0; sink < 2; sink++) {
+                FILE* in = std::tmpfile();
+                Assert::IsNotNull(in);
+                std::fwrite(input.data(), 1, input.size(), in);
+                std::rewind(in);
+
+                // A tiny buffer and mapping, so both have to flush or grow
+                SolutionWriter writer(200);
+                writer.SetFormat(SOutputFormat::PuzzleAndSolution);
+                Assert::IsTrue((sink == 0) ? writer.OpenFile(path) : writer.OpenMapped(path, 100));
+
+                BatchRunner runner;
+                Assert::IsTrue(runner.Run(in, writer));
+                Assert::IsTrue(writer.Close());
+                std::fclose(in);
+
+                Assert::AreEqual(expected, read_output());
+                Assert::AreEqual(uint64_t(expected.size()), writer.GetBytesWritten());
+                Assert::AreEqual(uint64_t(3), runner.GetStats().lines);
+                Assert::AreEqual(uint64_t(2), runner.GetStats().solved);
+                Assert::AreEqual(uint64_t(1), runner.GetStats().invalid);
+            }
+
+            std::filesystem::remove(path);
+        }
+	};
+
+	TEST_CLASS(SolutionVerifierTests)
+	{
+	public:
+        TEST_METHOD(TestVerifyGridsAndReport)
+        {
+            const std::string puzzle = "041032080070005000905107640200700009000040850006009300018624900009000000052003700";
+            const std::string solution = "641932587873465291925187643234758169197346852586219374718624935369571428452893716";
+
+            // Swapping two cells of a row keeps the row, but breaks the columns.
+            std::string swapped = solution;
+            std::swap(swapped[0], swapped[8]);
+            std::string changed = solution;
+            std::swap(changed[1], changed[2]);
+            std::string bad = solution;
+            bad[80] = '0';
+
+            struct { const std::string& solution; SVerifyResult expected; } cases[] = {
+                { solution, SVerifyResult::Valid },
+                { swapped, SVerifyResult::DuplicateValue },
+                { changed, SVerifyResult::GivenChanged },
+                { bad, SVerifyResult::BadCharacter },
+            };
+            for (const auto& c : cases) {
+                Assert::IsTrue(c.expected == SolutionVerifier::Verify(puzzle.data(), c.solution.data()));
+                Assert::IsTrue(c.expected == SolutionVerifier::VerifyScalar(puzzle.data(), c.solution.data()));
+            }
+
+            // A complete grid is its own puzzle.
+            Assert::IsTrue(SVerifyResult::Valid == SolutionVerifier::Verify(solution.data(), solution.data()));
+            Assert::IsTrue(SVerifyResult::BadFormat == SolutionVerifier::VerifyLine(puzzle));
+
+            const std::string input =
+                "quizzes,solutions\r\n" +
+                puzzle + "," + solution + "\r\n" +
+                "\n" +
+                puzzle + "," + swapped + "\n" +
+                puzzle + "," + solution;
+
+            FILE* in = std::tmpfile();
+            Assert::IsNotNull(in);
+            std::fwrite(input.data(), 1, input.size(), in);
+            std::rewind(in);
+
+            // A block smaller than a line, so the reader has to grow
+            LineReader reader(64);
+            reader.Attach(in);
+
+            auto path = (std::filesystem::temp_directory_path() / "ssolve_verify_test.txt").string();
+            SolutionWriter report;
+            Assert::IsTrue(report.OpenFile(path));
+
+            SolutionVerifier verifier;
+            Assert::IsTrue(verifier.Run(reader, report));
+            Assert::IsTrue(report.Close());
+            std::fclose(in);
+
+            std::ifstream file(path, std::ios::binary);
+            Assert::AreEqual(std::string("1,bad format\n4,duplicate value\n"),
+                std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+            file.close();
+            std::filesystem::remove(path);
+
+            Assert::AreEqual(uint64_t(4), verifier.GetStats().lines);
+            Assert::AreEqual(uint64_t(2), verifier.GetStats().valid);
+            Assert::AreEqual(uint64_t(1), verifier.GetStats().invalid);
+            Assert::AreEqual(uint64_t(1), verifier.GetStats().malformed);
+        }
+	};
+
+	TEST_CLASS(SolveLimitsTests)
+	{
+	public:
+        TEST_METHOD(TestBudgetsStopTheSearch)
+        {
+            // An empty board is never solved by elimination, so always searches.
+            SBoard empty;
+            SBoard board;
+            SBoard board_solved;
+            int steps = 0;
+
+            SolutionCache cache;
+            SudokuSolver solver;
+            solver.SetSolutionCache(&cache);
+
+            SSolveLimits limits;
+            limits.max_nodes = 1;
+            solver.SetLimits(limits);
+            board = empty;
+            Assert::IsTrue(SSolveStatus::NodeLimit == solver.SolveWithStatus(board, &board_solved, steps));
+            Assert::AreEqual(uint64_t(2), solver.GetNodeCount());
+            Assert::IsTrue(steps > 0);
+
+            limits = SSolveLimits{};
+            limits.max_seconds = 1e-9;
+            solver.SetLimits(limits);
+            board = empty;
+            Assert::IsTrue(SSolveStatus::TimedOut == solver.SolveWithStatus(board, &board_solved, steps));
+
+            std::atomic<bool> cancel{ true };
+            limits = SSolveLimits{};
+            limits.cancel = &cancel;
+            solver.SetLimits(limits);
+            board = empty;
+            Assert::IsFalse(solver.Solve(board, &board_solved, steps));
+
+            // Aborted solves are not cached, so the board still solves once
+            // the budget allows.
+            cancel = false;
+            board = empty;
+            Assert::IsTrue(SSolveStatus::Solved == solver.SolveWithStatus(board, &board_solved, steps));
+            Assert::IsTrue(board_solved.IsBoardSolved());
+
+            // A search entered directly starts a solve of its own, with the
+            // budget of the solver, even after one that was aborted
+            SudokuSolver direct;
+            SSolveLimits node_limits;
+            node_limits.max_nodes = 1;
+            direct.SetLimits(node_limits);
+            board = empty;
+            Assert::IsTrue(SSolveStatus::NodeLimit == direct.SolveWithStatus(board, &board_solved, steps));
+            Assert::IsFalse(direct.SolveBoardByRecursion(empty, &board_solved, steps));
+            Assert::AreEqual(uint64_t(2), direct.GetNodeCount());
+
+            direct.SetLimits(SSolveLimits{});
+            Assert::IsTrue(direct.SolveBoardByRecursion(empty, &board_solved, steps));
+            Assert::IsTrue(board_solved.IsBoardSolved());
+
+            // The token is checked by all the parallel workers
+            cancel = true;
+            ParallelSolver parallel_solver(2);
+            parallel_solver.SetLimits(limits);
+            board = empty;
+            Assert::IsTrue(SSolveStatus::Cancelled == parallel_solver.SolveWithStatus(board, &board_solved, steps));
+
+            limits = SSolveLimits{};
+            limits.max_nodes = 1;
+            parallel_solver.SetLimits(limits);
+            board = empty;
+            Assert::IsTrue(SSolveStatus::NodeLimit == parallel_solver.SolveWithStatus(board, &board_solved, steps));
+        }
+	};
+
+	TEST_CLASS(EliminationTests)
+	{
+	public:
+        TEST_METHOD(TestContradictionsAreFound)
+        {
+            SudokuSolver solver;
+            SBoard board;
+            SBoard board_solved;
+            int steps = 0;
+
+            // Bottom right cell: its row has 1 - 8, its column has 9. The givens do not
+            // clash, so without the check the search runs practically forever.
+            std::string no_candidates = "........9" + std::string(63, '.') + "12345678.";
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, no_candidates));
+            Assert::IsTrue(SEliminationResult::Contradiction == solver.Eliminate(board));
+
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, no_candidates));
+            Assert::IsTrue(SSolveStatus::Unsolved == solver.SolveWithStatus(board, &board_solved, steps));
+            Assert::IsTrue(solver.GetNodeCount() <= 1);
+
+            // Both free cells of the first row can only take 8, leaving no place for 9
+            std::string no_place = "1234567.." + std::string(18, '.') + ".......9." + std::string(18, '.') + "........9" + std::string(18, '.');
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, no_place));
+            Assert::IsTrue(SEliminationResult::Contradiction == solver.Eliminate(board));
+
+            std::string duplicate = "11" + std::string(79, '.');
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, duplicate));
+            Assert::IsTrue(SEliminationResult::Contradiction == solver.Eliminate(board));
+
+            // A solvable board makes progress, and still solves
+            std::string puzzle = "041032080070005000905107640200700009000040850006009300018624900009000000052003700";
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, puzzle));
+            Assert::IsTrue(SEliminationResult::Progress == solver.Eliminate(board));
+            Assert::IsTrue(solver.Solve(board, &board_solved, steps));
+            Assert::IsTrue(board_solved.IsBoardSolved());
+        }
+	};
+
+	TEST_CLASS(GridGeneratorTests)
+	{
+	public:
+        TEST_METHOD(TestGeneratedGridsAreSolved)
+        {
+            const std::string empty(BOARD_SIZE * BOARD_SIZE, '0');
+            auto to_layout = [](const GridGenerator::Grid& grid) {
+                std::string layout(BOARD_SIZE * BOARD_SIZE, '0');
+                for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                    layout[i] = static_cast<char>('0' + grid[i]);
+                }
+                return layout;
+            };
+
+            GridGenerator generator(12345);
+            generator.SetReseedInterval(50);
+
+            std::set<std::string> layouts;
+            GridGenerator::Grid grid;
+            for (int i = 0; i < 200; i++) {
+                generator.Generate(grid);
+                auto layout = to_layout(grid);
+                Assert::IsTrue(SVerifyResult::Valid == SolutionVerifier::Verify(empty.data(), layout.data()));
+                layouts.insert(layout);
+
+                generator.Fill(grid);
+                layout = to_layout(grid);
+                Assert::IsTrue(SVerifyResult::Valid == SolutionVerifier::Verify(empty.data(), layout.data()));
+            }
+            Assert::AreEqual(size_t(200), layouts.size());
+
+            // The same seed gives the same grids
+            GridGenerator first(7);
+            GridGenerator second(7);
+            GridGenerator::Grid other;
+            for (int i = 0; i < 10; i++) {
+                first.Generate(grid);
+                second.Generate(other);
+                Assert::AreEqual(to_layout(grid), to_layout(other));
+            }
+
+            // Matches the board version of the transform
+            SudokuSolver solver;
+            SBoard board;
+            SBoardTransform transform;
+            first.RandomTransform(transform);
+            first.Generate(grid);
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, to_layout(grid)));
+            GridGenerator::Apply(grid, transform, other);
+
+            char layout[BOARD_SIZE * BOARD_SIZE];
+            solver.GetBoardAsStringLayout(SBoardSymmetry::Apply(board, transform), layout);
+            Assert::AreEqual(to_layout(other), std::string(layout, BOARD_SIZE * BOARD_SIZE));
+
+            generator.Generate(board);
+            Assert::IsTrue(board.IsBoardSolved());
+        }
+	};
+
+	TEST_CLASS(PuzzleReducerTests)
+	{
+	public:
+        TEST_METHOD(TestReducedPuzzlesAreMinimal)
+        {
+            const std::string solution = "641932587873465291925187643234758169197346852586219374718624935369571428452893716";
+            PuzzleReducer::Grid grid;
+            for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                grid[i] = static_cast<uint8_t>(solution[i] - '0');
+            }
+
+            // Any number of threads gives a minimal puzzle of the same grid
+            for (int thread_count : { 1, 3 }) {
+                PuzzleReducer reducer(thread_count);
+                Assert::AreEqual(thread_count, reducer.GetThreadCount());
+
+                PuzzleReducer::Grid minimal;
+                Assert::IsTrue(reducer.Reduce(grid, minimal));
+                Assert::IsTrue(PuzzleReducer::IsMinimal(minimal));
+                Assert::AreEqual(1, PuzzleReducer::CountSolutions(minimal, 2));
+
+                int clues = 0;
+                for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                    if (minimal[i] != 0) {
+                        Assert::AreEqual(int(grid[i]), int(minimal[i]));
+                        clues++;
+                    }
+                }
+                Assert::AreEqual(clues, reducer.GetStats().clues);
+                Assert::IsTrue((clues >= 17) && (clues < 40));
+            }
+
+            // Puzzles without a unique solution are refused
+            PuzzleReducer reducer;
+            PuzzleReducer::Grid empty = {};
+            PuzzleReducer::Grid minimal;
+            Assert::IsFalse(reducer.Reduce(empty, minimal));
+            Assert::IsFalse(PuzzleReducer::IsMinimal(grid));
+
+            // The board version keeps the clues fixed
+            SBoard board;
+            GridGenerator generator(3);
+            generator.Generate(board);
+            Assert::IsTrue(reducer.Reduce(board));
+            Assert::IsFalse(board.IsBoardSolved());
+
+            SudokuSolver solver;
+            SBoard board_solved;
+            int steps = 0;
+            Assert::IsTrue(solver.Solve(board, &board_solved, steps));
+        }
+	};
+
+	TEST_CLASS(SolutionEnumeratorTests)
+	{
+	public:
+        TEST_METHOD(TestAllSolutionsAreListed)
+        {
+            // With the top three rows cleared, the bottom six rows allow 216 solutions
+            const std::string solution = "641932587873465291925187643234758169197346852586219374718624935369571428452893716";
+            SolutionEnumerator::Grid puzzle;
+            for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                puzzle[i] = (i < 27) ? 0 : static_cast<uint8_t>(solution[i] - '0');
+            }
+
+            for (int thread_count : { 1, 3 }) {
+                SolutionEnumerator enumerator(thread_count);
+                std::set<std::string> found;
+                bool is_valid = true;
+                auto count = enumerator.Enumerate(puzzle, [&](const SolutionEnumerator::Grid& grid) {
+                    std::string layout(BOARD_SIZE * BOARD_SIZE, '0');
+                    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                        layout[i] = static_cast<char>('0' + grid[i]);
+                        is_valid &= ((i < 27) || (grid[i] == puzzle[i]));
+                    }
+                    SBoard board;
+                    SudokuSolver solver;
+                    is_valid &= solver.LoadBoardFromStringLayout(board, std::string_view(layout)) && board.IsBoardSolved();
+                    found.insert(layout);
+                    return true;
+                });
+                Assert::AreEqual(uint64_t(216), count);
+                Assert::AreEqual(size_t(216), found.size());
+                Assert::IsTrue(is_valid);
+                Assert::IsTrue(found.count(solution) == 1);
+
+                // The limit, and a callback returning false, both stop the search
+                auto all = [](const SolutionEnumerator::Grid&) { return true; };
+                Assert::AreEqual(uint64_t(10), enumerator.Enumerate(puzzle, all, 10));
+
+                int calls = 0;
+                count = enumerator.Enumerate(puzzle, [&calls](const SolutionEnumerator::Grid&) { return ++calls < 5; });
+                Assert::AreEqual(uint64_t(5), count);
+                Assert::AreEqual(5, calls);
+            }
+
+            // Clashing clues have no solutions
+            SolutionEnumerator enumerator;
+            puzzle[0] = puzzle[27];
+            Assert::AreEqual(uint64_t(0), enumerator.Enumerate(puzzle, [](const SolutionEnumerator::Grid&) { return true; }));
+        }
+	};
+
+	TEST_CLASS(CheckpointTests)
+	{
+	public:
+        TEST_METHOD(TestBatchResumesWithTheSameOutput)
+        {
+            const std::vector<std::string> lines = {
+                "041032080070005000905107640200700009000040850006009300018624900009000000052003700",
+                "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7",
+                "116.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7"
+            };
+            auto input_path = (std::filesystem::temp_directory_path() / "ssolve_resume_input.txt").string();
+            auto output_path = (std::filesystem::temp_directory_path() / "ssolve_resume_output.txt").string();
+            {
+                std::ofstream file(input_path, std::ios::binary);
+                for (int i = 0; i < 300; i++) {
+                    file << lines[i % lines.size()] << '\n';
+                }
+            }
+            auto read_output = [&output_path]() {
+                std::ifstream file(output_path, std::ios::binary);
+                return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            };
+
+            BatchRunner runner;
+            SolutionWriter writer;
+            writer.SetFormat(SOutputFormat::PuzzleAndSolution);
+            Assert::IsTrue(writer.OpenFile(output_path));
+            Assert::IsTrue(runner.Run(input_path, writer));
+            Assert::IsTrue(writer.Close());
+            std::string expected = read_output();
+
+            // Stop at the first checkpoint, then write some lines past it, as a
+            // run killed between checkpoints would.
+            SBatchCheckpoint checkpoint;
+            BatchRunner stopped;
+            stopped.SetCheckpoint([&checkpoint](const SBatchCheckpoint& progress) { checkpoint = progress; return false; }, 0.0);
+            writer.SetFormat(SOutputFormat::PuzzleAndSolution);
+            Assert::IsTrue(writer.OpenFile(output_path));
+            Assert::IsFalse(stopped.Run(input_path, writer));
+            writer.WriteLine("partial line");
+            Assert::IsTrue(writer.Close());
+            Assert::AreEqual(uint64_t(64), checkpoint.line_number);
+            Assert::AreEqual(expected.substr(0, checkpoint.output_size), read_output().substr(0, checkpoint.output_size));
+
+            BatchRunner resumed;
+            Assert::IsTrue(writer.ResumeFile(output_path, checkpoint.output_size));
+            Assert::IsTrue(resumed.Resume(input_path, checkpoint, writer));
+            Assert::IsTrue(writer.Close());
+            Assert::AreEqual(expected, read_output());
+            Assert::AreEqual(runner.GetStats().solved, resumed.GetStats().solved);
+            Assert::AreEqual(runner.GetStats().invalid, resumed.GetStats().invalid);
+            Assert::AreEqual(uint64_t(300), resumed.GetStats().lines);
+
+            std::filesystem::remove(input_path);
+            std::filesystem::remove(output_path);
+        }
+
+        TEST_METHOD(TestEnumerationResumesFromTheFrontier)
+        {
+            // 5820 solutions, with the first 40 cells cleared
+            const std::string solution = "641932587873465291925187643234758169197346852586219374718624935369571428452893716";
+            SolutionEnumerator::Grid puzzle;
+            for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                puzzle[i] = (i < 40) ? 0 : static_cast<uint8_t>(solution[i] - '0');
+            }
+
+            std::vector<std::string> expected;
+            auto add_to = [](std::vector<std::string>& found) {
+                return [&found](const SolutionEnumerator::Grid& grid) {
+                    std::string layout(BOARD_SIZE * BOARD_SIZE, '0');
+                    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                        layout[i] = static_cast<char>('0' + grid[i]);
+                    }
+                    found.push_back(layout);
+                    return true;
+                };
+            };
+            SolutionEnumerator enumerator;
+            Assert::AreEqual(uint64_t(5820), enumerator.Enumerate(puzzle, add_to(expected)));
+
+            // Stop at every checkpoint, and resume from the saved frontier
+            auto path = (std::filesystem::temp_directory_path() / "ssolve_resume.ckpt").string();
+            for (int thread_count : { 1, 3 }) {
+                SolutionEnumerator stopping(thread_count);
+                bool has_stopped = false;
+                stopping.SetCheckpoint([&](const SEnumerationCheckpoint& progress) {
+                    CheckpointFile file;
+                    file.SetNumber("found", progress.found);
+                    file.GetLines() = progress.frontier;
+                    has_stopped = file.Save(path);
+                    return !has_stopped;
+                }, 0.0);
+
+                std::vector<std::string> found;
+                uint64_t count = stopping.Enumerate(puzzle, add_to(found));
+                int resumes = 0;
+                while (has_stopped) {
+                    has_stopped = false;
+                    CheckpointFile file;
+                    Assert::IsTrue(file.Load(path));
+
+                    SEnumerationCheckpoint checkpoint;
+                    checkpoint.found = file.GetNumber("found");
+                    checkpoint.frontier = file.GetLines();
+                    Assert::AreEqual(checkpoint.found, uint64_t(found.size()));
+                    count = stopping.Resume(checkpoint, add_to(found));
+                    resumes++;
+                }
+
+                Assert::IsTrue(resumes > 1);
+                Assert::AreEqual(uint64_t(5820), count);
+                if (thread_count == 1) {
+                    Assert::IsTrue(found == expected);
+                }
+                else {
+                    std::sort(found.begin(), found.end());
+                    std::vector<std::string> sorted = expected;
+                    std::sort(sorted.begin(), sorted.end());
+                    Assert::IsTrue(found == sorted);
+                }
+            }
+            std::filesystem::remove(path);
+        }
+	};
+
+	TEST_CLASS(TranspositionTableTests)
+	{
+	public:
+        TEST_METHOD(TestBoardHashesFollowTheValues)
+        {
+            SudokuSolver solver;
+            SBoard board;
+            Assert::AreEqual(uint64_t(0), board.GetHash());
+
+            std::string puzzle = "041032080070005000905107640200700009000040850006009300018624900009000000052003700";
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, puzzle));
+            uint64_t hash = board.GetHash();
+            Assert::AreNotEqual(uint64_t(0), hash);
+
+            // Set and cleared again, or set in another order, gives the same hash
+            board.SetCell(0, 0, SCell{ SValueEnum::SValue_6 });
+            Assert::AreNotEqual(hash, board.GetHash());
+            board.SetCell(0, 0, SCell{});
+            Assert::AreEqual(hash, board.GetHash());
+
+            SBoard other;
+            for (int i = BOARD_SIZE * BOARD_SIZE - 1; i >= 0; i--) {
+                other.SetCell(i % BOARD_SIZE, i / BOARD_SIZE, SBoard::CharacterToCell(puzzle[i]));
+            }
+            Assert::AreEqual(hash, other.GetHash());
+            other.UpdateHash();
+            Assert::AreEqual(hash, other.GetHash());
+
+            // The same value in another cell is another hash
+            other.SetCell(1, 0, SCell{ SValueEnum::SValue_6 });
+            board.SetCell(0, 0, SCell{ SValueEnum::SValue_6 });
+            Assert::AreNotEqual(board.GetHash(), other.GetHash());
+        }
+
+        TEST_METHOD(TestDeadBoardsAreSkipped)
+        {
+            // A single bucket holds eight hashes, and is reused once full
+            TranspositionTable small(0);
+            Assert::AreEqual(size_t(8), small.GetCapacity());
+            for (uint64_t hash = 1; hash <= 100; hash++) {
+                small.AddDead(hash << 32);
+                Assert::IsTrue(small.IsDead(hash << 32));
+            }
+            small.Clear();
+            Assert::IsFalse(small.IsDead(uint64_t(100) << 32));
+
+            TranspositionTable table(1024 * 1024);
+            Assert::AreEqual(size_t(1024 * 1024), table.GetSizeBytes());
+
+            // An expert puzzle with one wrong value, which takes a search to
+            // rule out. The second time, the search stops at the first node.
+            std::string no_solution = "4.1..36....3.271...........3...8..9..72.....11...5..4..3.........6.753..9.4..62..";
+            SudokuSolver solver;
+            solver.SetTranspositionTable(&table);
+            SBoard board;
+            SBoard board_solved;
+            int steps = 0;
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, no_solution));
+            Assert::IsTrue(SSolveStatus::Unsolved == solver.SolveWithStatus(board, &board_solved, steps));
+            Assert::IsTrue(solver.GetNodeCount() > 100);
+
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, no_solution));
+            Assert::IsTrue(SSolveStatus::Unsolved == solver.SolveWithStatus(board, &board_solved, steps));
+            Assert::AreEqual(uint64_t(1), solver.GetNodeCount());
+
+            // A table far too small for the search only loses entries, never solutions
+            TranspositionTable tiny(4096);
+            ParallelSolver parallel(3);
+            parallel.SetTranspositionTable(&tiny);
+            solver.SetTranspositionTable(&tiny);
+
+            const std::string puzzles[] = {
+                "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7,516497832849532671732168459453789126981625743267341598375216984128974365694853217",
+                "....2374.7.36..........7.5.2.5.....9.3.....6.6.7.....5.....6.1.9.41.........7823.,569823741743615892821497653215764389438259167697381425372546918984132576156978234",
+                ".46.5..7..35.7......26..5..3....79.2.9.....5.2.49....8..1..56......2.48..8..1.29.,946152873835479126712683549368547912197268354254931768421895637579326481683714295"
+            };
+            for (const auto& line : puzzles) {
+                SBoard solved;
+                for (int pass = 0; pass < 2; pass++) {
+                    Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string_view(line).substr(0, 81)));
+                    bool is_solved = (pass == 0) ? solver.Solve(board, &solved, steps) : parallel.Solve(board, &solved, steps);
+                    Assert::IsTrue(is_solved);
+
+                    char layout[BOARD_SIZE * BOARD_SIZE];
+                    solver.GetBoardAsStringLayout(solved, layout);
+                    Assert::AreEqual(line.substr(82, 81), std::string(layout, BOARD_SIZE * BOARD_SIZE));
+                }
+            }
+        }
+
+        TEST_METHOD(TestReusedParallelTableKeepsSolvableBoards)
+        {
+            // More workers than cores, and no split, so branches are handed
+            // over deep in the search. Boards above a handed over branch must
+            // not be stored as dead, or the next solve finds no solution.
+            const std::string puzzles[] = {
+                "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......",
+                "52...6.........7.13...........4..8..6......5...........418.........3..2...87....."
+            };
+            TranspositionTable table(1024 * 1024);
+            ParallelSolver parallel(6);
+            parallel.SetTranspositionTable(&table);
+            parallel.SetSplitDepth(0);
+
+            SudokuSolver solver;
+            for (int pass = 0; pass < 3; pass++) {
+                for (const auto& puzzle : puzzles) {
+                    SBoard board;
+                    SBoard solved;
+                    int steps = 0;
+                    Assert::IsTrue(solver.LoadBoardFromStringLayout(board, puzzle));
+                    Assert::IsTrue(SSolveStatus::Solved == parallel.SolveWithStatus(board, &solved, steps));
+                    Assert::IsTrue(solved.IsBoardSolved());
+                }
+            }
+        }
+	};
+
+	TEST_CLASS(BitboardTests)
+	{
+	public:
+        TEST_METHOD(TestPlanesFollowTheBoard)
+        {
+            SudokuSolver solver;
+            SBoard board;
+            std::string puzzle = "041032080070005000905107640200700009000040850006009300018624900009000000052003700";
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, puzzle));
+
+            SBitBoard bits;
+            Assert::IsTrue(bits.FromBoard(board));
+            for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                Assert::AreEqual(puzzle[i] - '0', bits.GetValue(i));
+                Assert::AreEqual(puzzle[i] != '0', bits.solved.Has(i));
+            }
+
+            // 4 is at cell 1, so it cannot go anywhere else in row 0, column 1 or block 0
+            for (int i : { 0, 8, 10, 19, 28, 73 }) {
+                Assert::IsFalse(bits.candidates[3].Has(i));
+            }
+            Assert::IsFalse(bits.Place(0, 3));
+
+            // Round trip, with the free cells solved
+            SBoard copy = board;
+            bits.ToBoard(copy);
+            Assert::AreEqual(solver.GetBoardAsStringLayout(board), solver.GetBoardAsStringLayout(copy));
+
+            // Clashing givens are found while loading
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, "11" + puzzle.substr(2)));
+            Assert::IsFalse(bits.FromBoard(board));
+
+            // The first row needs a 1 at cell 0, which the 1 below rules out
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, "023456789" + std::string(9, '0') + "1" + std::string(62, '0')));
+            Assert::IsTrue(bits.FromBoard(board));
+            Assert::IsFalse(BitboardSolver::Propagate(bits));
+        }
+
+        TEST_METHOD(TestEnginesGiveTheSameSolutions)
+        {
+            const std::string puzzles[] = {
+                "041032080070005000905107640200700009000040850006009300018624900009000000052003700,641932587873465291925187643234758169197346852586219374718624935369571428452893716",
+                "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7,516497832849532671732168459453789126981625743267341598375216984128974365694853217",
+                "....2374.7.36..........7.5.2.5.....9.3.....6.6.7.....5.....6.1.9.41.........7823.,569823741743615892821497653215764389438259167697381425372546918984132576156978234",
+                ".46.5..7..35.7......26..5..3....79.2.9.....5.2.49....8..1..56......2.48..8..1.29.,946152873835479126712683549368547912197268354254931768421895637579326481683714295"
+            };
+
+            SudokuSolver cells;
+            SudokuSolver bits;
+            bits.SetEngine(SSolverEngine::Bitboard);
+            Assert::IsTrue(SSolverEngine::Bitboard == bits.GetEngine());
+
+            for (const auto& line : puzzles) {
+                SBoard board;
+                SBoard solved;
+                int steps = 0;
+                Assert::IsTrue(bits.LoadBoardFromStringLayout(board, std::string_view(line).substr(0, 81)));
+                std::wstring given = bits.GetBoardAsStringLayout(board);
+                Assert::IsTrue(SSolveStatus::Solved == bits.SolveWithStatus(board, &solved, steps));
+                Assert::IsTrue(solved.IsBoardSolved());
+
+                // The given board is left as it was, and only its free cells are solved
+                Assert::AreEqual(given, bits.GetBoardAsStringLayout(board));
+                for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                    auto state = (given[i] == L'0') ? SStateEnum::SState_Solved : SStateEnum::SState_Fixed;
+                    Assert::IsTrue(state == solved.GetCellDirect(i).state);
+                }
+
+                char layout[BOARD_SIZE * BOARD_SIZE];
+                bits.GetBoardAsStringLayout(solved, layout);
+                Assert::AreEqual(line.substr(82, 81), std::string(layout, BOARD_SIZE * BOARD_SIZE));
+
+                Assert::IsTrue(cells.LoadBoardFromStringLayout(board, std::string_view(line).substr(0, 81)));
+                Assert::IsTrue(cells.Solve(board, &solved, steps));
+                cells.GetBoardAsStringLayout(solved, layout);
+                Assert::AreEqual(line.substr(82, 81), std::string(layout, BOARD_SIZE * BOARD_SIZE));
+            }
+
+            // The limits apply to the bitboard engine too
+            SBoard board;
+            SBoard solved;
+            int steps = 0;
+            SSolveLimits limits;
+            limits.max_nodes = 1;
+            bits.SetLimits(limits);
+            Assert::IsTrue(bits.LoadBoardFromStringLayout(board, std::string(81, '0')));
+            Assert::IsTrue(SSolveStatus::NodeLimit == bits.SolveWithStatus(board, &solved, steps));
+            Assert::IsFalse(solved.IsBoardSolved());
+
+            // As does the answer for a board with no solution
+            bits.SetLimits(SSolveLimits{});
+            Assert::IsTrue(bits.LoadBoardFromStringLayout(board, "4.1..36....3.271...........3...8..9..72.....11...5..4..3.........6.753..9.4..62.."));
+            Assert::IsTrue(SSolveStatus::Unsolved == bits.SolveWithStatus(board, &solved, steps));
+        }
+	};
+
+	TEST_CLASS(SatSolverTests)
+	{
+	public:
+        TEST_METHOD(TestBoardsAreSolvedOrProvenUnsolvable)
+        {
+            const std::string puzzles[] = {
+                "041032080070005000905107640200700009000040850006009300018624900009000000052003700,641932587873465291925187643234758169197346852586219374718624935369571428452893716",
+                "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7,516497832849532671732168459453789126981625743267341598375216984128974365694853217",
+                "....2374.7.36..........7.5.2.5.....9.3.....6.6.7.....5.....6.1.9.41.........7823.,569823741743615892821497653215764389438259167697381425372546918984132576156978234",
+                ".46.5..7..35.7......26..5..3....79.2.9.....5.2.49....8..1..56......2.48..8..1.29.,946152873835479126712683549368547912197268354254931768421895637579326481683714295"
+            };
+
+            SudokuSolver solver;
+            solver.SetEngine(SSolverEngine::Sat);
+            SBoard board;
+            SBoard solved;
+            int steps = 0;
+            for (const auto& line : puzzles) {
+                Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string_view(line).substr(0, 81)));
+                Assert::IsTrue(SSolveStatus::Solved == solver.SolveWithStatus(board, &solved, steps));
+
+                char layout[BOARD_SIZE * BOARD_SIZE];
+                solver.GetBoardAsStringLayout(solved, layout);
+                Assert::AreEqual(line.substr(82, 81), std::string(layout, BOARD_SIZE * BOARD_SIZE));
+            }
+
+            // An empty board has solutions, a board with clashing givens or
+            // needing a search to rule out has none
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string(81, '0')));
+            Assert::IsTrue(SSolveStatus::Solved == solver.SolveWithStatus(board, &solved, steps));
+            Assert::IsTrue(solved.IsBoardSolved());
+
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, "11" + std::string(79, '0')));
+            Assert::IsTrue(SSolveStatus::Unsolved == solver.SolveWithStatus(board, &solved, steps));
+
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, "4.1..36....3.271...........3...8..9..72.....11...5..4..3.........6.753..9.4..62.."));
+            Assert::IsTrue(SSolveStatus::Unsolved == solver.SolveWithStatus(board, &solved, steps));
+            Assert::IsFalse(solved.IsBoardSolved());
+        }
+
+        TEST_METHOD(TestHardBoardsAreHandedOver)
+        {
+            // Made to defeat backtracking in value order: the bitboard engine
+            // takes over half a million nodes, the SAT engine a few dozen.
+            std::string puzzle = ".....6....59.....82....8....45........3........6..3.54...325..6..................";
+
+            SudokuSolver solver;
+            solver.SetEngine(SSolverEngine::Bitboard);
+            SSolveLimits limits;
+            limits.max_nodes = 10000;
+            solver.SetLimits(limits);
+
+            SBoard board;
+            SBoard solved;
+            int steps = 0;
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, puzzle));
+            Assert::IsTrue(SSolveStatus::NodeLimit == solver.SolveWithStatus(board, &solved, steps));
+
+            solver.SetSatFallback(1000);
+            Assert::IsTrue(SSolveStatus::Solved == solver.SolveWithStatus(board, &solved, steps));
+            Assert::IsTrue(solved.IsBoardSolved());
+            Assert::IsTrue(solver.GetNodeCount() > 1000);
+            Assert::IsTrue(solver.GetNodeCount() < 2000);
+            for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                if (puzzle[i] != '.')
+                    Assert::AreEqual(puzzle[i] - '0', static_cast<int>(solved.GetCellDirect(i).value));
+            }
+
+            // The SAT engine on its own
+            SatSolver sat;
+            steps = 0;
+            Assert::IsTrue(sat.Solve(board, &solved, steps));
+            Assert::IsTrue(solved.IsBoardSolved());
+            Assert::IsTrue(sat.GetNodeCount() < 1000);
+            Assert::AreEqual(static_cast<int>(sat.GetNodeCount()), steps);
+
+            // A handover at or over the node limit never happens
+            limits.max_nodes = 1000;
+            solver.SetLimits(limits);
+            Assert::IsTrue(SSolveStatus::NodeLimit == solver.SolveWithStatus(board, &solved, steps));
+
+            // A handover that spends every node leaves none to the SAT engine
+            limits.max_nodes = 1001;
+            solver.SetLimits(limits);
+            Assert::IsTrue(SSolveStatus::NodeLimit == solver.SolveWithStatus(board, &solved, steps));
+            Assert::IsTrue(solver.GetNodeCount() <= 1001);
+        }
+	};
+
+	TEST_CLASS(ProbingTests)
+	{
+	public:
+        TEST_METHOD(TestProbesFindValuesAndContradictions)
+        {
+            std::string line = "..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7,516497832849532671732168459453789126981625743267341598375216984128974365694853217";
+
+            SudokuSolver solver;
+            SBoard board;
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string_view(line).substr(0, 81)));
+            Assert::IsTrue(SEliminationResult::Progress == solver.Probe(board));
+
+            // Every value found is the value of the solution, and is marked solved
+            int found = 0;
+            for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                auto cell = board.GetCellDirect(i);
+                if (cell.value == SValueEnum::SValue_Empty)
+                    continue;
+
+                Assert::AreEqual(line[82 + i] - '0', static_cast<int>(cell.value));
+                Assert::IsTrue((line[i] == '.') == (cell.state == SStateEnum::SState_Solved));
+                found += (line[i] == '.');
+            }
+            Assert::IsTrue(found > 0);
+
+            // Probing only the cells with two candidates finds fewer, or the same
+            solver.SetProbing(2);
+            SBoard pairs;
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(pairs, std::string_view(line).substr(0, 81)));
+            solver.Probe(pairs);
+            for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+                if (pairs.GetCellDirect(i).value != SValueEnum::SValue_Empty)
+                    Assert::IsTrue(pairs.GetCellDirect(i).value == board.GetCellDirect(i).value);
+            }
+
+            // Nothing left to find on a solved board, and clashing values are found
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string_view(line).substr(82, 81)));
+            Assert::IsTrue(SEliminationResult::NoChange == solver.Probe(board));
+            board.SetCell(0, 0, SCell{ SValueEnum::SValue_1 });
+            Assert::IsTrue(SEliminationResult::Contradiction == solver.Probe(board));
+        }
+
+        TEST_METHOD(TestProbingCutsTheSearch)
+        {
+            const std::string puzzles[] = {
+                "....2374.7.36..........7.5.2.5.....9.3.....6.6.7.....5.....6.1.9.41.........7823.,569823741743615892821497653215764389438259167697381425372546918984132576156978234",
+                ".46.5..7..35.7......26..5..3....79.2.9.....5.2.49....8..1..56......2.48..8..1.29.,946152873835479126712683549368547912197268354254931768421895637579326481683714295"
+            };
+
+            SudokuSolver solver;
+            solver.SetProbing(3);
+            Assert::AreEqual(3, solver.GetProbing());
+
+            for (const auto& line : puzzles) {
+                SBoard board;
+                SBoard solved;
+                int steps = 0;
+                Assert::IsTrue(solver.LoadBoardFromStringLayout(board, std::string_view(line).substr(0, 81)));
+                Assert::IsTrue(solver.Solve(board, &solved, steps));
+                Assert::IsTrue(solver.GetNodeCount() <= 10);
+
+                char layout[BOARD_SIZE * BOARD_SIZE];
+                solver.GetBoardAsStringLayout(solved, layout);
+                Assert::AreEqual(line.substr(82, 81), std::string(layout, BOARD_SIZE * BOARD_SIZE));
+            }
+
+            // A board with no solution is still found to have none
+            SBoard board;
+            SBoard solved;
+            int steps = 0;
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, "4.1..36....3.271...........3...8..9..72.....11...5..4..3.........6.753..9.4..62.."));
+            Assert::IsTrue(SSolveStatus::Unsolved == solver.SolveWithStatus(board, &solved, steps));
+        }
+	};
+
+	TEST_CLASS(ValueOrderTests)
+	{
+	public:
+        TEST_METHOD(TestLeastConstrainingOrderIsReproducible)
+        {
+            const std::string puzzles[] = {
+                std::string(81, '.'),
+                "....2374.7.36..........7.5.2.5.....9.3.....6.6.7.....5.....6.1.9.41.........7823.",
+                ".46.5..7..35.7......26..5..3....79.2.9.....5.2.49....8..1..56......2.48..8..1.29."
+            };
+
+            SudokuSolver solver;
+            Assert::IsTrue(SValueOrder::Random == solver.GetValueOrder());
+            solver.SetValueOrder(SValueOrder::LeastConstraining);
+
+            // Each run takes the same search to the same solution
+            for (const auto& puzzle : puzzles) {
+                std::wstring first_layout;
+                uint64_t first_nodes = 0;
+                int first_steps = 0;
+                for (int run = 0; run < 3; run++) {
+                    SBoard board;
+                    SBoard solved;
+                    int steps = 0;
+                    Assert::IsTrue(solver.LoadBoardFromStringLayout(board, puzzle));
+                    Assert::IsTrue(solver.Solve(board, &solved, steps));
+                    Assert::IsTrue(solved.IsBoardSolved());
+
+                    if (run == 0) {
+                        first_layout = solver.GetBoardAsStringLayout(solved);
+                        first_nodes = solver.GetNodeCount();
+                        first_steps = steps;
+                        continue;
+                    }
+                    Assert::AreEqual(first_layout, solver.GetBoardAsStringLayout(solved));
+                    Assert::AreEqual(first_nodes, solver.GetNodeCount());
+                    Assert::AreEqual(first_steps, steps);
+                }
+            }
+
+            // A blank board has all values equally constrained, so they go in
+            // ascending order along the first row
+            SBoard board;
+            SBoard solved;
+            int steps = 0;
+            Assert::IsTrue(solver.LoadBoardFromStringLayout(board, puzzles[0]));
+            Assert::IsTrue(solver.Solve(board, &solved, steps));
+            Assert::AreEqual(std::wstring(L"123456789"), solver.GetBoardAsStringLayout(solved).substr(0, 9));
+        }
+	};
+
+	TEST_CLASS(ShardTests)
+	{
+	public:
+        TEST_METHOD(TestShardRangesCoverTheFile)
+        {
+            const uint64_t sizes[] = { 0, 1, 7, 1000, 0xFFFFFFFFFFFull };
+            for (auto size : sizes) {
+                for (int count = 1; count <= 9; count++) {
+                    uint64_t next = 0;
+                    for (int i = 0; i < count; i++) {
+                        uint64_t begin = 0;
+                        uint64_t end = 0;
+                        BatchRunner::GetShardRange(size, i, count, begin, end);
+                        Assert::AreEqual(next, begin);
+                        Assert::IsTrue(begin <= end);
+                        next = end;
+                    }
+                    Assert::AreEqual(size, next);
+                }
+            }
+
+            int index = 0;
+            int count = 0;
+            Assert::IsTrue(BatchRunner::ParseShard("3/8", index, count));
+            Assert::AreEqual(3, index);
+            Assert::AreEqual(8, count);
+            Assert::IsFalse(BatchRunner::ParseShard("8/8", index, count));
+            Assert::IsFalse(BatchRunner::ParseShard("-1/8", index, count));
+            Assert::IsFalse(BatchRunner::ParseShard("1/0", index, count));
+            Assert::IsFalse(BatchRunner::ParseShard("1/", index, count));
+            Assert::IsFalse(BatchRunner::ParseShard("1", index, count));
+            Assert::IsFalse(BatchRunner::ParseShard("1/4x", index, count));
+        }
+
+        TEST_METHOD(TestShardOutputsJoinToTheWholeOutput)
+        {
+            // Lines of different lengths, so that shard boundaries fall at
+            // every point of a line, and no terminator on the last
+            const std::vector<std::string> lines = {
+                "041032080070005000905107640200700009000040850006009300018624900009000000052003700",
+                "7,..6.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7",
+                "",
+                "not a puzzle",
+                "116.9.8...4.532.7............37.91......2....2.73.15.8.75...98.128...3656.......7\r"
+            };
+            auto input_path = (std::filesystem::temp_directory_path() / "ssolve_shard_input.txt").string();
+            auto output_path = (std::filesystem::temp_directory_path() / "ssolve_shard_output.txt").string();
+            {
+                std::ofstream file(input_path, std::ios::binary);
+                for (int i = 0; i < 40; i++) {
+                    file << lines[i % lines.size()];
+                    if (i != 39)
+                        file << '\n';
+                }
+            }
+            auto read_output = [&output_path]() {
+                std::ifstream file(output_path, std::ios::binary);
+                return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            };
+            auto input_size = std::filesystem::file_size(input_path);
+
+            BatchRunner whole;
+            SolutionWriter writer;
+            writer.SetFormat(SOutputFormat::PuzzleAndSolution);
+            Assert::IsTrue(writer.OpenFile(output_path));
+            Assert::IsTrue(whole.Run(input_path, writer));
+            Assert::IsTrue(writer.Close());
+            std::string expected = read_output();
+
+            for (int count : { 1, 2, 3, 7, 40, 200 }) {
+                std::string joined;
+                SBatchStats stats;
+                for (int i = 0; i < count; i++) {
+                    uint64_t begin = 0;
+                    uint64_t end = 0;
+                    BatchRunner::GetShardRange(input_size, i, count, begin, end);
+
+                    // Each shard takes a final checkpoint, with the counts of its lines
+                    SBatchCheckpoint last;
+                    BatchRunner shard;
+                    shard.SetInputRange(begin, end);
+                    shard.SetCheckpoint([&last](const SBatchCheckpoint& progress) { last = progress; return true; }, 60.0);
+                    writer.SetFormat(SOutputFormat::PuzzleAndSolution);
+                    Assert::IsTrue(writer.OpenFile(output_path));
+                    Assert::IsTrue(shard.Run(input_path, writer));
+                    Assert::IsTrue(writer.Close());
+                    Assert::AreEqual(shard.GetStats().lines, last.stats.lines);
+                    Assert::AreEqual(writer.GetBytesWritten(), last.output_size);
+
+                    joined += read_output();
+                    stats.lines += last.stats.lines;
+                    stats.solved += last.stats.solved;
+                    stats.invalid += last.stats.invalid;
+                }
+                Assert::AreEqual(expected, joined);
+                Assert::AreEqual(whole.GetStats().lines, stats.lines);
+                Assert::AreEqual(whole.GetStats().solved, stats.solved);
+                Assert::AreEqual(whole.GetStats().invalid, stats.invalid);
+            }
+
+            // The counts a coordinator merges are read back from the checkpoint files
+            SBatchCheckpoint saved;
+            saved.input_offset = 12;
+            saved.stats = whole.GetStats();
+            auto checkpoint_path = output_path + ".ckpt";
+            Assert::IsTrue(BatchRunner::SaveCheckpoint(checkpoint_path, saved));
+            SBatchCheckpoint loaded;
+            Assert::IsTrue(BatchRunner::LoadCheckpoint(checkpoint_path, loaded));
+            Assert::AreEqual(uint64_t(12), loaded.input_offset);
+            Assert::AreEqual(whole.GetStats().solved, loaded.stats.solved);
+
+            std::filesystem::remove(input_path);
+            std::filesystem::remove(output_path);
+            std::filesystem::remove(checkpoint_path);
+        }
+	};
 }